@@ -0,0 +1,77 @@
+#include "GraphSnapshot.h"
+#include "SocialNetwork.h"
+#include <algorithm>
+
+namespace {
+// Heap storage for snapshots built from a SocialNetwork
+struct OwnedArrays {
+    vector<int> idTable;
+    vector<uint64_t> offsets;
+    vector<int> neighbors;
+};
+}
+
+GraphSnapshot::GraphSnapshot(const SocialNetwork& network) {
+    auto arrays = make_shared<OwnedArrays>();
+    auto& idTable = arrays->idTable;
+    auto& offsets = arrays->offsets;
+    auto& neighbors = arrays->neighbors;
+
+    // --- 1. Dense ID table (sorted so the mapping is deterministic and searchable) ---
+    const auto& allUsers = network.get_all_users();
+    idTable.assign(allUsers.begin(), allUsers.end());
+    sort(idTable.begin(), idTable.end());
+
+    int N = idTable.size();
+    numUsers = N;
+    idData = idTable.data(); // index_of() below needs the ID table
+
+    // --- 2. Row offsets from the degrees ---
+    offsets.assign(N + 1, 0);
+    for (int i = 0; i < N; ++i) {
+        offsets[i + 1] = offsets[i] + network.get_degree(idTable[i]);
+    }
+
+    // --- 3. Neighbor array (translated to dense indices, sorted per row) ---
+    neighbors.resize(offsets[N]);
+    for (int i = 0; i < N; ++i) {
+        int* row = neighbors.data() + offsets[i];
+        int written = 0;
+        for (int friendID : network.get_friends(idTable[i])) {
+            row[written++] = index_of(friendID);
+        }
+        sort(row, row + written);
+    }
+
+    offsetData = offsets.data();
+    neighborData = neighbors.data();
+    storage = std::move(arrays);
+}
+
+GraphSnapshot::GraphSnapshot(const int* ids, const uint64_t* offsets, const int* neighbors,
+                             int numUsers, shared_ptr<const void> owner)
+    : storage(std::move(owner)), idData(ids), offsetData(offsets), neighborData(neighbors), numUsers(numUsers) {}
+
+int GraphSnapshot::index_of(int userID) const {
+    const int* last = idData + numUsers;
+    const int* it = lower_bound(idData, last, userID);
+    if (it == last || *it != userID) {
+        return -1;
+    }
+    return static_cast<int>(it - idData);
+}
+
+
+uint64_t GraphSnapshot::fingerprint() const {
+    uint64_t hash = 0xcbf29ce484222325ULL ^ static_cast<uint64_t>(numUsers);
+    auto mix = [&hash](uint64_t word) {
+        hash ^= word;
+        hash *= 0x9E3779B97F4A7C15ULL;
+        hash ^= hash >> 29;
+    };
+    if (offsetData == nullptr) return hash; // empty placeholder snapshot
+    for (int i = 0; i < numUsers; ++i) mix(static_cast<uint32_t>(idData[i]));
+    for (int i = 0; i <= numUsers; ++i) mix(offsetData[i]);
+    for (uint64_t i = 0; i < offsetData[numUsers]; ++i) mix(static_cast<uint32_t>(neighborData[i]));
+    return hash;
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+using namespace std;
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+class SocialNetwork;
+
+//Immutable, read-only view of a SocialNetwork in compressed-sparse-row (CSR) form.
+//Sparse user IDs (e.g. 1..20 and 90) are remapped to dense indices 0..N-1 in
+//ascending ID order, so every per-user array can be a plain vector indexed by
+//position instead of a hash map keyed by ID.
+//The neighbors of index v are neighbors[offsets[v] .. offsets[v+1]), sorted ascending.
+//Copies are cheap: they share the same underlying arrays.
+class GraphSnapshot {
+public:
+    //A contiguous [begin, end) run of ints, usable in range-for loops.
+    struct IntRange {
+        const int* first;
+        const int* last;
+        const int* begin() const { return first; }
+        const int* end() const { return last; }
+        size_t size() const { return static_cast<size_t>(last - first); }
+        bool empty() const { return first == last; }
+    };
+
+    //Builds the snapshot from the network's current adjacency lists.
+    //network The populated SocialNetwork object.
+    explicit GraphSnapshot(const SocialNetwork& network);
+
+    //Wraps CSR arrays owned by someone else (e.g. a memory-mapped file) without copying.
+    //ids Sorted user IDs (numUsers entries).
+    //offsets Row offsets (numUsers + 1 entries).
+    //neighbors Sorted neighbor indices per row (offsets[numUsers] entries).
+    //owner Keeps the arrays alive for as long as any copy of this snapshot exists.
+    GraphSnapshot(const int* ids, const uint64_t* offsets, const int* neighbors,
+                  int numUsers, shared_ptr<const void> owner);
+
+    //Number of users (dense indices run from 0 to num_users() - 1).
+    int num_users() const { return numUsers; }
+
+    //Number of undirected friendships (each stored twice in the CSR arrays).
+    size_t num_edges() const { return offsetData[numUsers] / 2; }
+
+    //Translates a user ID into its dense index.
+    //Returns -1 if the user is not in the snapshot.
+    int index_of(int userID) const;
+
+    //Translates a dense index back into the original user ID.
+    int user_id(int index) const { return idData[index]; }
+
+    //Gets the sorted neighbor indices of a user (by dense index).
+    IntRange neighbors_of(int index) const {
+        return {neighborData + offsetData[index], neighborData + offsetData[index + 1]};
+    }
+
+    //Gets the degree (friend count) of a user (by dense index).
+    int degree(int index) const { return static_cast<int>(offsetData[index + 1] - offsetData[index]); }
+
+    //The ID translation table: user_ids()[index] == user_id(index), sorted ascending.
+    IntRange user_ids() const { return {idData, idData + numUsers}; }
+
+    //64-bit hash of the user IDs and friendships. Equal graphs give equal
+    //fingerprints, so files derived from a snapshot can check they still match it.
+    uint64_t fingerprint() const;
+
+    //Raw CSR arrays, for serialization.
+    const uint64_t* offsets() const { return offsetData; }
+    const int* neighbors() const { return neighborData; }
+
+private:
+    shared_ptr<const void> storage; // owns the arrays below (vectors or a file mapping)
+    const int* idData;              // dense index -> user ID (sorted, so index_of can binary search)
+    const uint64_t* offsetData;     // N + 1 row offsets into 'neighborData'
+    const int* neighborData;        // concatenated, sorted neighbor indices
+    int numUsers;
+};
@@ -0,0 +1,351 @@
+#include "GraphStore.h"
+#include "SocialNetwork.h"
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+#include <vector>
+#include <cstring>
+#include <sys/mman.h> // mmap / munmap
+#include <sys/stat.h> // fstat
+#include <fcntl.h>    // open
+#include <unistd.h>   // close
+
+namespace {
+
+const char MAGIC[8] = {'S', 'G', 'R', 'A', 'P', 'H', 'B', '\0'};
+
+// Fixed-size file header. Every offset is in bytes from the start of the file.
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t numUsers;
+    uint64_t numArcs;         // CSR neighbor entries (2 per friendship)
+    uint64_t numTags;
+    uint64_t numUserTags;     // total (user, tag) pairs
+    uint64_t sectionOffset[MappedGraph::NUM_SECTIONS];
+    uint64_t sectionChecksum[MappedGraph::NUM_SECTIONS]; // each section on its own (see MappedGraph::verify)
+    uint64_t fileSize;
+    uint64_t checksum;        // over this header with checksum = 0
+};
+
+size_t padded(size_t bytes) {
+    return (bytes + 7) & ~size_t(7);
+}
+
+// 64-bit checksum over 8-byte words. Sections are padded to 8 bytes, so a
+// section can be hashed in pieces with the same result as all at once.
+uint64_t checksum_words(uint64_t hash, const unsigned char* data, size_t bytes) {
+    for (size_t i = 0; i < bytes; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        hash ^= word;
+        hash *= 0x9E3779B97F4A7C15ULL;
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
+
+const uint64_t CHECKSUM_SEED = 0xcbf29ce484222325ULL;
+
+const char* const SECTION_NAMES[MappedGraph::NUM_SECTIONS] = {
+    "ID table", "CSR offsets", "CSR neighbors", "tag offsets", "tag blob", "user tag rows", "user tag IDs"};
+
+// Appends one section (zero-padded to 8 bytes) and records its offset and checksum.
+void write_section(ofstream& out, const void* data, size_t bytes, FileHeader& header, int section, uint64_t& offset) {
+    const unsigned char* bytePtr = static_cast<const unsigned char*>(data);
+    uint64_t checksum = CHECKSUM_SEED;
+    size_t whole = bytes & ~size_t(7);
+    if (whole > 0) {
+        out.write(reinterpret_cast<const char*>(bytePtr), whole);
+        checksum = checksum_words(checksum, bytePtr, whole);
+    }
+    if (whole < bytes) {
+        unsigned char tail[8] = {0};
+        memcpy(tail, bytePtr + whole, bytes - whole);
+        out.write(reinterpret_cast<const char*>(tail), 8);
+        checksum = checksum_words(checksum, tail, 8);
+    }
+    header.sectionOffset[section] = offset;
+    header.sectionChecksum[section] = checksum;
+    offset += padded(bytes);
+}
+
+// Owns an mmap'd region and unmaps it on destruction.
+struct FileMapping {
+    void* base = MAP_FAILED;
+    size_t length = 0;
+    ~FileMapping() {
+        if (base != MAP_FAILED) munmap(base, length);
+    }
+};
+
+// Hashes the header with its checksum field zeroed, so a flipped count, offset
+// or section checksum is caught before anything is read from the payload.
+uint64_t checksum_header(FileHeader header) {
+    header.checksum = 0;
+    return checksum_words(CHECKSUM_SEED, reinterpret_cast<const unsigned char*>(&header), sizeof(header));
+}
+
+// A section must start where the previous one ended (8-byte aligned, as
+// write_section lays them out) and end inside the file.
+bool section_fits(uint64_t offset, uint64_t count, uint64_t elementSize, uint64_t& cursor, uint64_t fileSize) {
+    if (offset != cursor || offset % 8 != 0) return false;
+    if (count > (fileSize - offset) / elementSize) return false; // also rules out overflow
+    cursor = offset + padded(count * elementSize);
+    return cursor <= fileSize;
+}
+
+// Each row of a sorted-row array must be strictly ascending.
+bool rows_sorted(const uint64_t* offsets, uint64_t rows, const int* values) {
+    for (uint64_t r = 0; r < rows; ++r) {
+        for (uint64_t i = offsets[r] + 1; i < offsets[r + 1]; ++i) {
+            if (values[i - 1] >= values[i]) return false;
+        }
+    }
+    return true;
+}
+
+// Row offsets must start at 0, never decrease and end at 'total'.
+bool offsets_valid(const uint64_t* offsets, uint64_t rows, uint64_t total) {
+    if (offsets[0] != 0 || offsets[rows] != total) return false;
+    for (uint64_t i = 0; i < rows; ++i) {
+        if (offsets[i] > offsets[i + 1]) return false;
+    }
+    return true;
+}
+
+bool fail(string* error, const string& reason) {
+    if (error) *error = reason;
+    return false;
+}
+
+}
+
+bool GraphStore::write(const SocialNetwork& network, const string& binFile) {
+    GraphSnapshot graph = network.freeze();
+    uint64_t N = graph.num_users();
+    uint64_t numArcs = graph.offsets()[N];
+
+    // --- 1. Tag table (the network's interned tag dictionary) ---
+    const TagDictionary& dictionary = network.tag_dictionary();
+    vector<uint64_t> userTagOffsets(N + 1, 0);
+    vector<int> userTagIds;
+    for (uint64_t v = 0; v < N; ++v) {
+        const auto& ids = network.get_tag_ids(graph.user_id(v));
+        userTagIds.insert(userTagIds.end(), ids.begin(), ids.end());
+        userTagOffsets[v + 1] = userTagIds.size();
+    }
+
+    vector<uint64_t> tagOffsets(dictionary.size() + 1, 0);
+    string tagBlob;
+    for (int t = 0; t < dictionary.size(); ++t) {
+        tagBlob += dictionary.name(t);
+        tagOffsets[t + 1] = tagBlob.size();
+    }
+
+    // --- 2. Write the sections after a placeholder header ---
+    // (write to a temporary file first so a crash never leaves a half-written .bin behind)
+    string tmpFile = binFile + ".tmp";
+    ofstream out(tmpFile, ios::binary | ios::trunc);
+    if (!out.is_open()) {
+        cerr << "  Error: Could not open " << tmpFile << " for writing." << endl;
+        return false;
+    }
+
+    FileHeader header = {};
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.headerSize = sizeof(FileHeader);
+    header.numUsers = N;
+    header.numArcs = numArcs;
+    header.numTags = dictionary.size();
+    header.numUserTags = userTagIds.size();
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    uint64_t offset = sizeof(FileHeader);
+    write_section(out, graph.user_ids().begin(), N * sizeof(int), header, MappedGraph::IDS, offset);
+    write_section(out, graph.offsets(), (N + 1) * sizeof(uint64_t), header, MappedGraph::OFFSETS, offset);
+    write_section(out, graph.neighbors(), numArcs * sizeof(int), header, MappedGraph::NEIGHBORS, offset);
+    write_section(out, tagOffsets.data(), tagOffsets.size() * sizeof(uint64_t), header,
+                  MappedGraph::TAG_OFFSETS, offset);
+    write_section(out, tagBlob.data(), tagBlob.size(), header, MappedGraph::TAG_BLOB, offset);
+    write_section(out, userTagOffsets.data(), userTagOffsets.size() * sizeof(uint64_t), header,
+                  MappedGraph::USER_TAG_OFFSETS, offset);
+    write_section(out, userTagIds.data(), userTagIds.size() * sizeof(int), header,
+                  MappedGraph::USER_TAG_IDS, offset);
+
+    header.fileSize = offset;
+    header.checksum = checksum_header(header);
+
+    // --- 3. Patch in the real header ---
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+    if (!out) {
+        cerr << "  Error: Failed while writing " << tmpFile << "." << endl;
+        return false;
+    }
+
+    error_code ec;
+    filesystem::rename(tmpFile, binFile, ec);
+    if (ec) {
+        cerr << "  Error: Could not replace " << binFile << ": " << ec.message() << endl;
+        return false;
+    }
+    return true;
+}
+
+bool GraphStore::convert(const string& edgeFile, const string& tagFile, const string& binFile) {
+    SocialNetwork network;
+    network.load_data(edgeFile, tagFile);
+    return write(network, binFile);
+}
+
+bool GraphStore::is_fresh(const string& binFile, const string& edgeFile, const string& tagFile) {
+    error_code ec;
+    auto binTime = filesystem::last_write_time(binFile, ec);
+    if (ec) return false;
+    for (const string& source : {edgeFile, tagFile}) {
+        auto sourceTime = filesystem::last_write_time(source, ec);
+        if (!ec && sourceTime >= binTime) return false; // text was edited after conversion
+    }
+    return true;
+}
+
+shared_ptr<const MappedGraph> MappedGraph::open(const string& path, string* error, bool verifyPayload) {
+    // --- 1. Map the whole file read-only ---
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        fail(error, "cannot open " + path);
+        return nullptr;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(FileHeader)) {
+        ::close(fd);
+        fail(error, path + " is too small to be a graph file");
+        return nullptr;
+    }
+
+    auto mapping = make_shared<FileMapping>();
+    mapping->length = info.st_size;
+    mapping->base = mmap(nullptr, mapping->length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping stays valid after the descriptor is closed
+    if (mapping->base == MAP_FAILED) {
+        fail(error, "mmap failed for " + path);
+        return nullptr;
+    }
+    const unsigned char* bytes = static_cast<const unsigned char*>(mapping->base);
+
+    // --- 2. Validate the header (O(1): the payload is not touched) ---
+    FileHeader header;
+    memcpy(&header, bytes, sizeof(header));
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        fail(error, path + " is not a graph file");
+        return nullptr;
+    }
+    if (header.version != GraphStore::FORMAT_VERSION || header.headerSize != sizeof(FileHeader)) {
+        fail(error, path + " has format version " + to_string(header.version) +
+                    ", expected " + to_string(GraphStore::FORMAT_VERSION));
+        return nullptr;
+    }
+    if (header.fileSize != mapping->length) {
+        fail(error, path + " is truncated (" + to_string(mapping->length) + " of " +
+                    to_string(header.fileSize) + " bytes)");
+        return nullptr;
+    }
+    if (checksum_header(header) != header.checksum) {
+        fail(error, path + " failed its header checksum (corrupt or partially written)");
+        return nullptr;
+    }
+
+    // --- 3. Validate the layout before pointing anything into the mapping ---
+    uint64_t N = header.numUsers;
+    const uint64_t* offset = header.sectionOffset;
+    uint64_t cursor = header.headerSize;
+    uint64_t sectionBytes[NUM_SECTIONS] = {};
+    auto fits = [&](int section, uint64_t count, uint64_t elementSize) {
+        sectionBytes[section] = padded(count * elementSize); // only used once the section fits
+        return section_fits(offset[section], count, elementSize, cursor, header.fileSize);
+    };
+    bool layoutValid =
+        N < uint64_t(INT32_MAX) && header.numTags < uint64_t(INT32_MAX) &&
+        fits(IDS, N, sizeof(int)) &&
+        fits(OFFSETS, N + 1, sizeof(uint64_t)) &&
+        fits(NEIGHBORS, header.numArcs, sizeof(int)) &&
+        fits(TAG_OFFSETS, header.numTags + 1, sizeof(uint64_t));
+    if (layoutValid) {
+        const uint64_t* tagOffsets = reinterpret_cast<const uint64_t*>(bytes + offset[TAG_OFFSETS]);
+        layoutValid =
+            fits(TAG_BLOB, tagOffsets[header.numTags], 1) &&
+            fits(USER_TAG_OFFSETS, N + 1, sizeof(uint64_t)) &&
+            fits(USER_TAG_IDS, header.numUserTags, sizeof(int)) &&
+            cursor == header.fileSize;
+    }
+    if (!layoutValid) {
+        fail(error, path + " has an inconsistent section layout");
+        return nullptr;
+    }
+
+    // --- 4. Point the views into the mapping ---
+    shared_ptr<MappedGraph> result(new MappedGraph());
+    result->mapping = mapping;
+    result->path = path;
+    result->numArcs = header.numArcs;
+    result->numUserTags = header.numUserTags;
+    for (int section = 0; section < NUM_SECTIONS; ++section) {
+        result->sectionData[section] = bytes + offset[section];
+        result->sectionBytes[section] = sectionBytes[section];
+        result->sectionChecksum[section] = header.sectionChecksum[section];
+    }
+    result->graph = GraphSnapshot(
+        reinterpret_cast<const int*>(bytes + offset[IDS]),
+        reinterpret_cast<const uint64_t*>(bytes + offset[OFFSETS]),
+        reinterpret_cast<const int*>(bytes + offset[NEIGHBORS]),
+        static_cast<int>(N),
+        mapping);
+    result->numTags = header.numTags;
+    result->tagOffsets = reinterpret_cast<const uint64_t*>(bytes + offset[TAG_OFFSETS]);
+    result->tagBlob = reinterpret_cast<const char*>(bytes + offset[TAG_BLOB]);
+    result->userTagOffsets = reinterpret_cast<const uint64_t*>(bytes + offset[USER_TAG_OFFSETS]);
+    result->userTagIds = reinterpret_cast<const int*>(bytes + offset[USER_TAG_IDS]);
+
+    // --- 5. Optionally check the whole payload now ---
+    if (verifyPayload && !result->verify(error)) return nullptr;
+    return result;
+}
+
+bool MappedGraph::verify(string* error) const {
+    // --- 1. Every section against its own checksum ---
+    for (int section = 0; section < NUM_SECTIONS; ++section) {
+        if (checksum_words(CHECKSUM_SEED, sectionData[section], sectionBytes[section]) != sectionChecksum[section]) {
+            return fail(error, path + ": the " + SECTION_NAMES[section] + " section failed its checksum");
+        }
+    }
+
+    // --- 2. Every row and every stored index must stay inside its section ---
+    uint64_t N = graph.num_users();
+    const int* ids = graph.user_ids().begin();
+    bool valid =
+        offsets_valid(tagOffsets, numTags, tagOffsets[numTags]) &&
+        offsets_valid(graph.offsets(), N, numArcs) &&
+        offsets_valid(userTagOffsets, N, numUserTags);
+    for (uint64_t v = 1; valid && v < N; ++v) {
+        valid = ids[v - 1] < ids[v]; // index_of binary-searches the ID table
+    }
+    const int* neighbors = graph.neighbors();
+    for (uint64_t i = 0; valid && i < numArcs; ++i) {
+        valid = neighbors[i] >= 0 && uint64_t(neighbors[i]) < N;
+    }
+    for (uint64_t i = 0; valid && i < numUserTags; ++i) {
+        valid = userTagIds[i] >= 0 && uint64_t(userTagIds[i]) < numTags;
+    }
+    // Neighbor and tag ID rows are searched and merged as sorted lists
+    valid = valid && rows_sorted(graph.offsets(), N, neighbors) && rows_sorted(userTagOffsets, N, userTagIds);
+    if (!valid) return fail(error, path + " has out-of-range rows or indices");
+    return true;
+}
+
+string MappedGraph::tag_name(int tagID) const {
+    return string(tagBlob + tagOffsets[tagID], tagOffsets[tagID + 1] - tagOffsets[tagID]);
+}
@@ -0,0 +1,100 @@
+#pragma once
+using namespace std;
+#include "GraphSnapshot.h"
+#include <string>
+#include <memory>
+#include <cstdint>
+
+class SocialNetwork;
+
+//Versioned binary graph file, opened read-only with mmap.
+//
+//Layout (little-endian, every section padded to 8 bytes):
+//  Header          magic "SGRAPHB", format version, counts, section offsets and
+//                  checksums, file size, header checksum
+//  ID table        int32  [N]      dense index -> user ID (sorted)
+//  CSR offsets     uint64 [N + 1]
+//  CSR neighbors   int32  [offsets[N]]
+//  Tag offsets     uint64 [T + 1]  into the tag string blob
+//  Tag blob        char   [...]    interned tag strings, back to back
+//  User tag rows   uint64 [N + 1]  into the user tag ID array
+//  User tag IDs    int32  [...]    interned tag IDs per user (sorted per user)
+//
+//Opening only reads the header: its checksum, the recorded file size and the
+//section layout are checked in O(1), so a truncated file or a damaged header is
+//rejected before any pointer into the mapping is handed out. Each section also
+//has its own checksum; verify() checks those and every stored row and index
+//(O(file size)), which open() does unless asked not to.
+class MappedGraph {
+public:
+    //Sections in file order (indices into the header's offset and checksum tables).
+    enum Section { IDS, OFFSETS, NEIGHBORS, TAG_OFFSETS, TAG_BLOB, USER_TAG_OFFSETS, USER_TAG_IDS, NUM_SECTIONS };
+
+    //Maps a binary graph file and validates its header and layout.
+    //path The .bin file written by GraphStore::write().
+    //error Receives a human-readable reason if the file is rejected.
+    //verifyPayload Also run verify() before returning. Skip it only for files
+    //this process wrote or already verified: a damaged payload that is not
+    //verified can send the readers out of bounds.
+    //Returns nullptr if the file is missing, stale-format, truncated or corrupt.
+    static shared_ptr<const MappedGraph> open(const string& path, string* error = nullptr,
+                                              bool verifyPayload = true);
+
+    //Checks every section against its checksum, and that every row offset,
+    //neighbor index and tag ID is in range and every row is sorted.
+    //error Receives the first problem found.
+    bool verify(string* error = nullptr) const;
+
+    //The friendship graph, pointing straight into the mapping (no copy).
+    //Copies of the snapshot keep the file mapped even after this object is gone.
+    const GraphSnapshot& snapshot() const { return graph; }
+
+    //Number of distinct interned tags.
+    int num_tags() const { return static_cast<int>(numTags); }
+
+    //Gets an interned tag's text (by tag ID).
+    string tag_name(int tagID) const;
+
+    //Gets the interned tag IDs of a user (by dense index), sorted ascending.
+    GraphSnapshot::IntRange tags_of(int index) const {
+        return {userTagIds + userTagOffsets[index], userTagIds + userTagOffsets[index + 1]};
+    }
+
+private:
+    MappedGraph() : graph(nullptr, nullptr, nullptr, 0, nullptr) {}
+
+    shared_ptr<const void> mapping; // unmaps the file when the last user lets go
+    string path;                    // for error messages
+    GraphSnapshot graph;
+    uint64_t numArcs = 0;
+    uint64_t numTags = 0;
+    uint64_t numUserTags = 0;
+    const uint64_t* tagOffsets = nullptr;
+    const char* tagBlob = nullptr;
+    const uint64_t* userTagOffsets = nullptr;
+    const int* userTagIds = nullptr;
+
+    // Per-section byte ranges (padded) and expected checksums, for verify()
+    const unsigned char* sectionData[NUM_SECTIONS] = {};
+    uint64_t sectionBytes[NUM_SECTIONS] = {};
+    uint64_t sectionChecksum[NUM_SECTIONS] = {};
+};
+
+//Writes and converts binary graph files.
+class GraphStore {
+public:
+    //Current on-disk format version; files with another version are rejected.
+    static constexpr uint32_t FORMAT_VERSION = 3;
+
+    //Writes the network (friendships and tags) as a binary graph file.
+    //Returns true on success.
+    static bool write(const SocialNetwork& network, const string& binFile);
+
+    //Converts the text edge/tag files into a binary graph file.
+    //Returns true on success.
+    static bool convert(const string& edgeFile, const string& tagFile, const string& binFile);
+
+    //Checks whether binFile exists and is newer than both text files,
+    //i.e. whether it can be loaded instead of re-parsing the text.
+    static bool is_fresh(const string& binFile, const string& edgeFile, const string& tagFile);
+};
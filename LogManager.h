@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <string_view>
 
 struct LogEvent {
     std::string type;
@@ -24,14 +25,15 @@ public:
     }
 
     // Set algorithm metadata
-    static void setAlgorithm(std::string name, std::string description, int userID = -1) {
-        algorithmName = name;
-        algorithmDescription = description;
+    // (views + assign: the strings keep their capacity, so repeated queries don't allocate)
+    static void setAlgorithm(std::string_view name, std::string_view description, int userID = -1) {
+        algorithmName.assign(name);
+        algorithmDescription.assign(description);
         targetUserID = userID;
     }
 
     // Updated log function with optional 'fromID' and 'value'
-    static void log(std::string type, int nodeID, int fromID = -1, double value = 0.0) {
-        events.push_back({type, nodeID, fromID, value});
+    static void log(std::string_view type, int nodeID, int fromID = -1, double value = 0.0) {
+        events.push_back({std::string(type), nodeID, fromID, value});
     }
 };
\ No newline at end of file
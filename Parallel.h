@@ -0,0 +1,32 @@
+#pragma once
+#include <thread>
+#include <vector>
+
+// Small helpers for the multi-threaded loaders and analytics.
+// Everything here is plain std::thread; there is no global pool to manage.
+
+
+//Resolves a requested thread count: values <= 0 mean "one per hardware thread".
+
+inline int resolve_thread_count(int requested) {
+    if (requested > 0) return requested;
+    unsigned hardware = std::thread::hardware_concurrency();
+    return hardware == 0 ? 1 : static_cast<int>(hardware);
+}
+
+
+//Runs fn(threadIndex) for threadIndex = 0 .. threads-1 and waits for all of them.
+//Thread 0 runs on the calling thread, so threads == 1 never spawns anything.
+
+template <typename Fn>
+void run_in_parallel(int threads, Fn fn) {
+    std::vector<std::thread> workers;
+    workers.reserve(threads > 1 ? threads - 1 : 0);
+    for (int t = 1; t < threads; ++t) {
+        workers.emplace_back(fn, t);
+    }
+    fn(0);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
@@ -1,67 +1,417 @@
 #include "SocialNetwork.h"
+#include "GraphSnapshot.h"
+#include "GraphStore.h"
 #include <fstream>   // For reading files (ifstream)
 #include <sstream>   // For splitting strings (stringstream)
 #include <iostream>  // For error messages (cerr)
+#include <charconv>  // For std::from_chars (fast integer parsing)
+#include <cstring>   // For memchr
+#include <string_view>
+#include <chrono>
+#include <atomic>
+#include <mutex>     // For std::call_once
+#include "Parallel.h"
 // using namespace std;
 
-// Define the static members
-const unordered_set<int> SocialNetwork::EMPTY_FRIEND_SET = {};
-const unordered_set<string> SocialNetwork::EMPTY_TAG_SET = {};
+namespace {
 
-void SocialNetwork::save_data(const string& edgeFile, const string& tagFile) const {
-    
-    // --- 1. Save Edges ---
-    ofstream edgeStream(edgeFile);
-    if (!edgeStream.is_open()) {
-        cerr << "  Error: Could not open " << edgeFile << " for writing." << endl;
-        return;
+// --- Helpers for load_data_parallel ---
+
+bool read_whole_file(const string& path, string& buffer) {
+    ifstream in(path, ios::binary | ios::ate);
+    if (!in.is_open()) return false;
+    buffer.resize(static_cast<size_t>(in.tellg()));
+    in.seekg(0);
+    in.read(&buffer[0], buffer.size());
+    return true;
+}
+
+// Splits [0, size) into 'parts' ranges whose boundaries fall just after a newline.
+vector<size_t> newline_aligned_chunks(const string& buffer, int parts) {
+    vector<size_t> bounds(parts + 1, buffer.size());
+    bounds[0] = 0;
+    for (int t = 1; t < parts; ++t) {
+        size_t pos = max(bounds[t - 1], buffer.size() * t / parts);
+        while (pos > 0 && pos < buffer.size() && buffer[pos - 1] != '\n') ++pos;
+        bounds[t] = pos;
     }
+    return bounds;
+}
 
-    // Use a set to avoid saving "1 2" and "2 1"
-    set<pair<int, int>> savedEdges;
+inline bool is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
 
+// Parses one whitespace-separated int from [p, end), like 'stream >> value'.
+inline bool parse_int(const char*& p, const char* end, int& value) {
+    while (p < end && is_blank(*p)) ++p;
+    auto [next, ec] = from_chars(p, end, value);
+    if (ec != errc()) return false;
+    p = next;
+    return true;
+}
+
+// Returns the end of the line starting at p (the '\n' or 'end').
+inline const char* line_end(const char* p, const char* end) {
+    const void* newline = memchr(p, '\n', end - p);
+    return newline ? static_cast<const char*>(newline) : end;
+}
+
+// --- Helpers for save_data and journal compaction ---
+
+// Every undirected edge once, as (smaller, larger)
+vector<pair<int, int>> capture_edges(const unordered_map<int, unordered_set<int>>& adjList) {
+    vector<pair<int, int>> edges;
     for (const auto& [userA, friends] : adjList) {
         for (int userB : friends) {
-            // Ensure we only save (smaller, larger) pairs
-            int u = min(userA, userB);
-            int v = max(userA, userB);
-            
-            if (savedEdges.find({u, v}) == savedEdges.end()) {
-                edgeStream << u << " " << v << "\n";
-                savedEdges.insert({u, v});
-            }
+            if (userA <= userB) edges.push_back({userA, userB});
         }
     }
+    return edges;
+}
+
+// Every user that has at least one tag (users with no tags are not saved)
+vector<pair<int, vector<string>>> capture_tags(const unordered_map<int, unordered_set<string>>& userTags) {
+    vector<pair<int, vector<string>>> tags;
+    for (const auto& [userID, tagSet] : userTags) {
+        if (tagSet.empty()) continue;
+        tags.push_back({userID, vector<string>(tagSet.begin(), tagSet.end())});
+    }
+    return tags;
+}
+
+// The same two lists, read from a mapped binary graph instead
+vector<pair<int, int>> capture_edges(const GraphSnapshot& graph) {
+    vector<pair<int, int>> edges;
+    edges.reserve(graph.num_edges());
+    for (int v = 0; v < graph.num_users(); ++v) {
+        for (int w : graph.neighbors_of(v)) {
+            if (v <= w) edges.push_back({graph.user_id(v), graph.user_id(w)});
+        }
+    }
+    return edges;
+}
+
+vector<pair<int, vector<string>>> capture_tags(const MappedGraph& file) {
+    vector<pair<int, vector<string>>> tags;
+    const GraphSnapshot& graph = file.snapshot();
+    for (int v = 0; v < graph.num_users(); ++v) {
+        auto tagIDs = file.tags_of(v);
+        if (tagIDs.empty()) continue;
+        vector<string> names;
+        for (int t : tagIDs) names.push_back(file.tag_name(t));
+        tags.push_back({graph.user_id(v), std::move(names)});
+    }
+    return tags;
+}
+
+// Writes the edge and tag files via temporaries + rename, so a crash never
+// leaves a half-written base file behind.
+bool write_base_files(const vector<pair<int, int>>& edges,
+                      const vector<pair<int, vector<string>>>& tags,
+                      const string& edgeFile, const string& tagFile) {
+    // --- 1. Save Edges ---
+    string edgeTmp = edgeFile + ".tmp";
+    ofstream edgeStream(edgeTmp);
+    if (!edgeStream.is_open()) {
+        cerr << "  Error: Could not open " << edgeFile << " for writing." << endl;
+        return false;
+    }
+    for (const auto& [u, v] : edges) {
+        edgeStream << u << " " << v << "\n";
+    }
     edgeStream.close();
 
     // --- 2. Save Tags ---
-    ofstream tagStream(tagFile);
+    string tagTmp = tagFile + ".tmp";
+    ofstream tagStream(tagTmp);
     if (!tagStream.is_open()) {
         cerr << "  Error: Could not open " << tagFile << " for writing." << endl;
-        return;
+        return false;
     }
-
-    // We can iterate through all users, even those with no tags,
-    // but it's cleaner to just iterate the tag map.
-    for (const auto& [userID, tags] : userTags) {
-        if (tags.empty()) continue; // Don't save users with no tags
-
+    for (const auto& [userID, userTagList] : tags) {
         tagStream << userID;
-        for (const string& tag : tags) {
+        for (const string& tag : userTagList) {
             tagStream << " " << tag;
         }
         tagStream << "\n";
     }
     tagStream.close();
 
-    cout << "  Success: Network data saved to files." << endl;
+    if (!edgeStream || !tagStream ||
+        rename(edgeTmp.c_str(), edgeFile.c_str()) != 0 ||
+        rename(tagTmp.c_str(), tagFile.c_str()) != 0) {
+        cerr << "  Error: Could not replace " << edgeFile << " / " << tagFile << "." << endl;
+        return false;
+    }
+    return true;
 }
 
-void SocialNetwork::load_data(const string& edgeFile, const string& tagFile) {
-    // Clear existing data to prevent duplication if called multiple times
+// A parsed tag line: user ID plus its tag tokens (views into the file buffer).
+struct TagLine {
+    int userID;
+    size_t firstToken; // index into the per-thread token array
+    size_t tokenCount;
+};
+
+// One lazily built value per dense index. Several reader threads may ask for
+// the same row at once: each builds a copy, the first to publish it wins and
+// the others free theirs, so readers never take a lock.
+template <typename Row>
+class LazyRows {
+public:
+    explicit LazyRows(int count) : rows(new atomic<Row*>[count]()), count(count) {}
+
+    ~LazyRows() {
+        for (int i = 0; i < count; ++i) delete rows[i].load(memory_order_relaxed);
+    }
+
+    template <typename Build>
+    const Row& get(int index, Build build) {
+        Row* row = rows[index].load(memory_order_acquire);
+        if (row) return *row;
+        Row* fresh = new Row(build());
+        if (rows[index].compare_exchange_strong(row, fresh, memory_order_acq_rel)) return *fresh;
+        delete fresh; // another thread published first; 'row' now holds its copy
+        return *row;
+    }
+
+private:
+    unique_ptr<atomic<Row*>[]> rows;
+    int count;
+};
+
+}
+
+// Read-only view of a mapped binary graph, with the per-user hash sets the
+// accessors hand out built on first use (see load_binary)
+struct SocialNetwork::MappedView {
+    shared_ptr<const MappedGraph> file;
+    vector<string> tagNames;  // by tag ID (the file's IDs are the dictionary's)
+    LazyRows<unordered_set<int>> friends;
+    LazyRows<unordered_set<string>> tags;
+    LazyRows<vector<int>> tagIDs;
+
+    once_flag usersBuilt, postingsBuilt;
+    unordered_set<int> users;       // get_all_users()
+    vector<vector<int>> postings;   // get_tag_users()
+
+    explicit MappedView(shared_ptr<const MappedGraph> mappedFile)
+        : file(std::move(mappedFile)),
+          friends(file->snapshot().num_users()),
+          tags(file->snapshot().num_users()),
+          tagIDs(file->snapshot().num_users()) {}
+
+    const GraphSnapshot& graph() const { return file->snapshot(); }
+};
+
+// Define the static members
+const unordered_set<int> SocialNetwork::EMPTY_FRIEND_SET = {};
+const unordered_set<string> SocialNetwork::EMPTY_TAG_SET = {};
+const vector<int> SocialNetwork::EMPTY_TAG_ID_LIST = {};
+
+SocialNetwork::~SocialNetwork() {
+    wait_for_compaction();
+}
+
+void SocialNetwork::reset_graph() {
+    wait_for_compaction(); // A background compaction may still be writing the base files
+    mapped.reset();
     adjList.clear();
     userTags.clear();
     allUserIDs.clear();
+    tagDictionary.clear();
+    userTagIDs.clear();
+    tagPostings.clear();
+    history.clear(); // A load is a new base; nothing before it can be replayed
+    mark_changed();
+}
+
+void SocialNetwork::mark_changed() {
+    // Stamps come from one process-wide counter, so a (version) key can never
+    // collide between two different SocialNetwork objects either
+    static atomic<uint64_t> versionCounter{0};
+    frozen.reset();
+    version = ++versionCounter;
+}
+
+void SocialNetwork::record_change(GraphChange::Kind kind, int userA, int userB) {
+    history.push_back({kind, userA, userB, version});
+    if (history.size() > MAX_HISTORY) {
+        history.pop_front();
+    }
+    mark_changed();
+}
+
+void SocialNetwork::index_tags(int userID) {
+    // Take the user out of the posting lists of their old tags first
+    auto old = userTagIDs.find(userID);
+    if (old != userTagIDs.end()) {
+        for (int tagID : old->second) {
+            vector<int>& posting = tagPostings[tagID];
+            auto it = find(posting.begin(), posting.end(), userID);
+            if (it != posting.end()) {
+                *it = posting.back();
+                posting.pop_back();
+            }
+        }
+    }
+
+    const auto& tags = get_tags(userID);
+    if (tags.empty()) {
+        userTagIDs.erase(userID);
+        return;
+    }
+    vector<int>& ids = userTagIDs[userID];
+    ids.clear();
+    for (const string& tag : tags) {
+        ids.push_back(tagDictionary.intern(tag));
+    }
+    sort(ids.begin(), ids.end());
+
+    tagPostings.resize(tagDictionary.size());
+    for (int tagID : ids) {
+        tagPostings[tagID].push_back(userID);
+    }
+}
+
+void SocialNetwork::index_all_tags() {
+    userTagIDs.clear();
+    tagPostings.clear();
+    userTagIDs.reserve(userTags.size());
+    for (const auto& [userID, tags] : userTags) {
+        index_tags(userID);
+    }
+}
+
+void SocialNetwork::save_data(const string& edgeFile, const string& tagFile) const {
+    // Each undirected edge is captured once as (smaller, larger), straight
+    // from the adjacency lists (or the mapped CSR), so no dedup set is needed
+    bool saved = mapped
+        ? write_base_files(capture_edges(mapped->graph()), capture_tags(*mapped->file), edgeFile, tagFile)
+        : write_base_files(capture_edges(adjList), capture_tags(userTags), edgeFile, tagFile);
+    if (saved) {
+        cout << "  Success: Network data saved to files." << endl;
+    }
+}
+
+void SocialNetwork::enable_journal(const string& journalFile, size_t compactThreshold) {
+    wait_for_compaction();
+    journalStream.close();
+    journalPath = journalFile;
+    journalThreshold = compactThreshold;
+    journalRecords = 0;
+}
+
+void SocialNetwork::replay_journal() {
+    if (journalPath.empty()) return;
+    wait_for_compaction();
+    journalStream.close();
+
+    // A ".compacting" journal is left behind if we crashed mid-compaction;
+    // its records are older than the live journal, so replay it first.
+    // Replaying records the base files already contain is harmless.
+    journalRecords = 0;
+    for (const string& path : {journalPath + ".compacting", journalPath}) {
+        ifstream in(path);
+        string line;
+        while (getline(in, line)) {
+            stringstream ss(line);
+            string op;
+            int userA, userB;
+            if (!(ss >> op >> userA)) continue; // Skip empty or torn lines
+            materialize();
+
+            if (op == "U") {
+                unordered_set<string> tags;
+                string tag;
+                while (ss >> tag) tags.insert(tag);
+                allUserIDs.insert(userA);
+                userTags[userA] = tags;
+                index_tags(userA);
+                adjList[userA]; // Ensure an (empty) friend set exists
+            } else if ((op == "+" || op == "-") && ss >> userB) {
+                if (!allUserIDs.count(userA) || !allUserIDs.count(userB)) continue;
+                if (op == "+") {
+                    adjList[userA].insert(userB);
+                    adjList[userB].insert(userA);
+                } else {
+                    adjList[userA].erase(userB);
+                    adjList[userB].erase(userA);
+                }
+            } else {
+                continue;
+            }
+            mark_changed();
+            journalRecords++;
+        }
+    }
+
+    journalStream.open(journalPath, ios::app);
+    if (!journalStream.is_open()) {
+        cerr << "Error: Could not open journal " << journalPath << " for appending." << endl;
+    }
+}
+
+void SocialNetwork::append_journal(const string& record) {
+    if (journalPath.empty()) return;
+    if (!journalStream.is_open()) {
+        journalStream.open(journalPath, ios::app);
+    }
+    // Flush every record so a crash loses nothing that was acknowledged
+    journalStream << record << '\n' << flush;
+    journalRecords++;
+}
+
+void SocialNetwork::commit_changes(const string& edgeFile, const string& tagFile) {
+    if (journalPath.empty()) {
+        save_data(edgeFile, tagFile);
+        return;
+    }
+
+    journalStream.flush();
+    if (journalRecords < journalThreshold) {
+        cout << "  Success: " << journalRecords << " change(s) are safe in the journal." << endl;
+        return;
+    }
+
+    // --- Compaction: fold the journal into fresh base files ---
+    wait_for_compaction();
+
+    // 1. Capture the current state while we still own the thread
+    vector<pair<int, int>> edges = capture_edges(adjList);
+    vector<pair<int, vector<string>>> tags = capture_tags(userTags);
+
+    // 2. Retire the live journal; new mutations go to a fresh one.
+    //    (If an older .compacting survived a crash, keep its records too.)
+    string compactingPath = journalPath + ".compacting";
+    journalStream.close();
+    {
+        ifstream live(journalPath);
+        ofstream retired(compactingPath, ios::app);
+        retired << live.rdbuf();
+    }
+    journalStream.open(journalPath, ios::trunc);
+    journalRecords = 0;
+
+    // 3. Rewrite the base files in the background, then drop the retired journal
+    compactor = thread([edges = std::move(edges), tags = std::move(tags), edgeFile, tagFile, compactingPath]() {
+        if (write_base_files(edges, tags, edgeFile, tagFile)) {
+            remove(compactingPath.c_str());
+        }
+    });
+    cout << "  Success: Changes saved; compacting the journal into the data files in the background." << endl;
+}
+
+void SocialNetwork::wait_for_compaction() {
+    if (compactor.joinable()) {
+        compactor.join();
+    }
+}
+
+void SocialNetwork::load_data(const string& edgeFile, const string& tagFile) {
+    // Clear existing data to prevent duplication if called multiple times
+    reset_graph();
     
     ifstream edgeStream(edgeFile);
     string line;
@@ -113,13 +463,218 @@ void SocialNetwork::load_data(const string& edgeFile, const string& tagFile) {
         }
     }
     tagStream.close();
+
+    index_all_tags();
+    replay_journal();
+}
+
+bool SocialNetwork::load_binary(const string& binFile, bool verifyPayload) {
+    reset_graph();
+
+    string error;
+    shared_ptr<const MappedGraph> file = MappedGraph::open(binFile, &error, verifyPayload);
+    if (!file) {
+        cerr << "Error: Could not load binary graph: " << error << endl;
+        return false;
+    }
+
+    // Resolve each interned tag string once (interning them in file order
+    // keeps the file's tag IDs as the dictionary's IDs)
+    mapped = make_shared<MappedView>(file);
+    mapped->tagNames.resize(file->num_tags());
+    for (int t = 0; t < file->num_tags(); ++t) {
+        mapped->tagNames[t] = file->tag_name(t);
+        tagDictionary.intern(mapped->tagNames[t]);
+    }
+
+    // The mapped CSR arrays already describe this exact graph
+    frozen = make_shared<const GraphSnapshot>(file->snapshot());
+
+    replay_journal();
+    return true;
+}
+
+void SocialNetwork::materialize() {
+    if (!mapped) return;
+    shared_ptr<MappedView> view = std::move(mapped); // the accessors now read the hash sets
+    const GraphSnapshot& graph = view->graph();
+    int N = graph.num_users();
+
+    // --- Rebuild the mutable adjacency lists from the CSR arrays (no parsing) ---
+    allUserIDs.reserve(N);
+    adjList.reserve(N);
+    for (int v = 0; v < N; ++v) {
+        int userID = graph.user_id(v);
+        allUserIDs.insert(userID);
+
+        auto neighbors = graph.neighbors_of(v);
+        auto& friends = adjList[userID];
+        friends.reserve(neighbors.size());
+        for (int w : neighbors) {
+            friends.insert(graph.user_id(w));
+        }
+
+        auto tagIDs = view->file->tags_of(v);
+        if (!tagIDs.empty()) {
+            auto& tags = userTags[userID];
+            for (int t : tagIDs) {
+                tags.insert(view->tagNames[t]);
+            }
+        }
+    }
+    index_all_tags();
+}
+
+IngestStats SocialNetwork::load_data_parallel(const string& edgeFile, const string& tagFile, int threads) {
+    auto startTime = chrono::steady_clock::now();
+
+    // Clear existing data to prevent duplication if called multiple times
+    reset_graph();
+
+    IngestStats stats;
+    stats.threads = resolve_thread_count(threads);
+    int T = stats.threads;
+
+    string buffer;
+    if (!read_whole_file(edgeFile, buffer)) {
+        cerr << "Error: Could not open edge file " << edgeFile << endl;
+        return stats;
+    }
+    stats.bytes += buffer.size();
+
+    // --- Load Edges: parse chunks concurrently into per-thread arc buffers ---
+    vector<size_t> bounds = newline_aligned_chunks(buffer, T);
+    vector<vector<pair<int, int>>> arcs(T);
+    run_in_parallel(T, [&](int t) {
+        const char* p = buffer.data() + bounds[t];
+        const char* end = buffer.data() + bounds[t + 1];
+        auto& out = arcs[t];
+        out.reserve((end - p) / 2); // generous guess: lines are at least 4 bytes
+        while (p < end) {
+            const char* eol = line_end(p, end);
+            int userA, userB;
+            const char* cursor = p;
+            if (p < eol && *p != '#' && parse_int(cursor, eol, userA) && parse_int(cursor, eol, userB)) {
+                // CRITICAL: Add edge in both directions for undirected graph
+                out.push_back({userA, userB});
+                out.push_back({userB, userA});
+            }
+            p = eol < end ? eol + 1 : end; // the last line may have no newline
+        }
+    });
+
+    // --- Merge: concatenate, sort by (user, friend) and drop duplicates ---
+    size_t totalArcs = 0;
+    for (const auto& part : arcs) totalArcs += part.size();
+    stats.edges = totalArcs / 2;
+
+    vector<pair<int, int>> allArcs;
+    allArcs.reserve(totalArcs);
+    for (auto& part : arcs) {
+        allArcs.insert(allArcs.end(), part.begin(), part.end());
+        vector<pair<int, int>>().swap(part); // release as we go
+    }
+    sort(allArcs.begin(), allArcs.end());
+    allArcs.erase(unique(allArcs.begin(), allArcs.end()), allArcs.end());
+
+    // --- Build the adjacency lists: each user's sorted run becomes one friend set ---
+    // 1. One map entry per user, serially (every endpoint starts a run)
+    vector<size_t> runStart;
+    for (size_t i = 0; i < allArcs.size(); ++i) {
+        if (i == 0 || allArcs[i].first != allArcs[i - 1].first) runStart.push_back(i);
+    }
+    size_t numRuns = runStart.size();
+    runStart.push_back(allArcs.size());
+
+    vector<unordered_set<int>*> friendSets(numRuns); // map nodes never move, so these stay valid
+    adjList.reserve(numRuns);
+    allUserIDs.reserve(numRuns);
+    for (size_t r = 0; r < numRuns; ++r) {
+        int userID = allArcs[runStart[r]].first;
+        friendSets[r] = &adjList[userID];
+        // Add the user to the master user list
+        allUserIDs.insert(userID);
+    }
+
+    // 2. Fill the sets in parallel: each thread owns the users whose runs start
+    //    in its share of the arcs, so no set is touched by two threads
+    auto first_run = [&](int t) {
+        size_t arc = allArcs.size() * t / T;
+        return static_cast<size_t>(lower_bound(runStart.begin(), runStart.begin() + numRuns, arc) - runStart.begin());
+    };
+    run_in_parallel(T, [&](int t) {
+        for (size_t r = first_run(t), last = first_run(t + 1); r < last; ++r) {
+            unordered_set<int>& friends = *friendSets[r];
+            friends.reserve(runStart[r + 1] - runStart[r]);
+            for (size_t k = runStart[r]; k < runStart[r + 1]; ++k) {
+                friends.insert(allArcs[k].second);
+            }
+        }
+    });
+
+    // --- Load Tags ---
+    if (!read_whole_file(tagFile, buffer)) {
+        cerr << "Error: Could not open tag file " << tagFile << endl;
+        stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+        return stats;
+    }
+    stats.bytes += buffer.size();
+
+    bounds = newline_aligned_chunks(buffer, T);
+    vector<vector<TagLine>> tagLines(T);
+    vector<vector<string_view>> tokens(T);
+    run_in_parallel(T, [&](int t) {
+        const char* p = buffer.data() + bounds[t];
+        const char* end = buffer.data() + bounds[t + 1];
+        while (p < end) {
+            const char* eol = line_end(p, end);
+            int userID;
+            const char* cursor = p;
+            if (p < eol && *p != '#' && parse_int(cursor, eol, userID)) {
+                TagLine line = {userID, tokens[t].size(), 0};
+                while (true) {
+                    while (cursor < eol && is_blank(*cursor)) ++cursor;
+                    if (cursor == eol) break;
+                    const char* tokenStart = cursor;
+                    while (cursor < eol && !is_blank(*cursor)) ++cursor;
+                    tokens[t].emplace_back(tokenStart, cursor - tokenStart);
+                }
+                line.tokenCount = tokens[t].size() - line.firstToken;
+                tagLines[t].push_back(line);
+            }
+            p = eol < end ? eol + 1 : end; // the last line may have no newline
+        }
+    });
+
+    // Apply the tag lines in file order (chunks are in file order too)
+    for (int t = 0; t < T; ++t) {
+        for (const TagLine& line : tagLines[t]) {
+            // This user is now in the network, even if they have 0 friends
+            allUserIDs.insert(line.userID);
+            if (line.tokenCount == 0) continue;
+
+            auto& tags = userTags[line.userID];
+            for (size_t k = 0; k < line.tokenCount; ++k) {
+                tags.emplace(tokens[t][line.firstToken + k]);
+            }
+        }
+        stats.tagLines += tagLines[t].size();
+    }
+
+    index_all_tags();
+    replay_journal();
+
+    stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    return stats;
 }
 
 bool SocialNetwork::user_exists(int userID) const {
+    if (mapped) return mapped->graph().index_of(userID) != -1;
     return allUserIDs.count(userID);
 }
 
 void SocialNetwork::add_friendship(int userA, int userB) {
+    materialize();
     // Only add if both users exist
     if (!allUserIDs.count(userA) || !allUserIDs.count(userB)) {
         cout << "  Error: One or both users do not exist." << endl;
@@ -128,10 +683,13 @@ void SocialNetwork::add_friendship(int userA, int userB) {
     
     adjList[userA].insert(userB);
     adjList[userB].insert(userA);
+    record_change(GraphChange::ADD_FRIENDSHIP, userA, userB);
+    append_journal("+ " + to_string(userA) + " " + to_string(userB));
     cout << "  Success: Friendship added between " << userA << " and " << userB << "." << endl;
 }
 
 void SocialNetwork::remove_friendship(int userA, int userB) {
+    materialize();
     // Only remove if both users exist
     if (!allUserIDs.count(userA) || !allUserIDs.count(userB)) {
         cout << "  Error: One or both users do not exist." << endl;
@@ -140,10 +698,23 @@ void SocialNetwork::remove_friendship(int userA, int userB) {
 
     adjList[userA].erase(userB);
     adjList[userB].erase(userA);
+    record_change(GraphChange::REMOVE_FRIENDSHIP, userA, userB);
+    append_journal("- " + to_string(userA) + " " + to_string(userB));
     cout << "  Success: Friendship removed between " << userA << " and " << userB << "." << endl;
 }
 
 const unordered_set<int>& SocialNetwork::get_friends(int userID) const {
+    if (mapped) {
+        const GraphSnapshot& graph = mapped->graph();
+        int v = graph.index_of(userID);
+        if (v == -1) return EMPTY_FRIEND_SET;
+        return mapped->friends.get(v, [&]() {
+            unordered_set<int> friends(graph.degree(v));
+            for (int w : graph.neighbors_of(v)) friends.insert(graph.user_id(w));
+            return friends;
+        });
+    }
+
     // Use .find() for safe access
     auto it = adjList.find(userID);
     if (it == adjList.end()) {
@@ -153,6 +724,16 @@ const unordered_set<int>& SocialNetwork::get_friends(int userID) const {
 }
 
 const unordered_set<string>& SocialNetwork::get_tags(int userID) const {
+    if (mapped) {
+        int v = mapped->graph().index_of(userID);
+        if (v == -1 || mapped->file->tags_of(v).empty()) return EMPTY_TAG_SET;
+        return mapped->tags.get(v, [&]() {
+            unordered_set<string> tags;
+            for (int t : mapped->file->tags_of(v)) tags.insert(mapped->tagNames[t]);
+            return tags;
+        });
+    }
+
     // Use .find() for safe access
     auto it = userTags.find(userID);
     if (it == userTags.end()) {
@@ -161,25 +742,125 @@ const unordered_set<string>& SocialNetwork::get_tags(int userID) const {
     return it->second; // Return reference to the real tag list
 }
 
+const vector<int>& SocialNetwork::get_tag_ids(int userID) const {
+    if (mapped) {
+        int v = mapped->graph().index_of(userID);
+        if (v == -1 || mapped->file->tags_of(v).empty()) return EMPTY_TAG_ID_LIST;
+        return mapped->tagIDs.get(v, [&]() {
+            auto row = mapped->file->tags_of(v); // sorted in the file, as here
+            return vector<int>(row.begin(), row.end());
+        });
+    }
+
+    auto it = userTagIDs.find(userID);
+    if (it == userTagIDs.end()) {
+        return EMPTY_TAG_ID_LIST;
+    }
+    return it->second;
+}
+
+const vector<int>& SocialNetwork::get_tag_users(int tagID) const {
+    const vector<vector<int>>* postings = &tagPostings;
+    if (mapped) {
+        MappedView& view = *mapped;
+        call_once(view.postingsBuilt, [&view]() {
+            const GraphSnapshot& graph = view.graph();
+            view.postings.resize(view.file->num_tags());
+            for (int v = 0; v < graph.num_users(); ++v) {
+                for (int t : view.file->tags_of(v)) view.postings[t].push_back(graph.user_id(v));
+            }
+        });
+        postings = &view.postings;
+    }
+
+    if (tagID < 0 || tagID >= static_cast<int>(postings->size())) {
+        return EMPTY_TAG_ID_LIST; // (an empty int list either way)
+    }
+    return (*postings)[tagID];
+}
+
+const TagDictionary& SocialNetwork::tag_dictionary() const {
+    return tagDictionary;
+}
+
 const unordered_set<int>& SocialNetwork::get_all_users() const {
+    if (mapped) {
+        MappedView& view = *mapped;
+        call_once(view.usersBuilt, [&view]() {
+            auto ids = view.graph().user_ids();
+            view.users.reserve(ids.size());
+            view.users.insert(ids.begin(), ids.end());
+        });
+        return view.users;
+    }
     return allUserIDs;
 }
 
+size_t SocialNetwork::num_users() const {
+    return mapped ? mapped->graph().num_users() : allUserIDs.size();
+}
+
 int SocialNetwork::get_degree(int userID) const {
+    if (mapped) {
+        int v = mapped->graph().index_of(userID);
+        return v == -1 ? 0 : mapped->graph().degree(v);
+    }
     // This is now safe because get_friends handles non-existent users
     return get_friends(userID).size();
 }
 
 void SocialNetwork::add_user(int userID, const unordered_set<string>& tags) {
+    materialize();
+
     // 1. Add to the master list
     allUserIDs.insert(userID);
 
-    // 2. Add/Overwrite their tags
+    // 2. Add/Overwrite their tags (and their interned tag IDs)
     userTags[userID] = tags;
+    index_tags(userID);
 
     // 3. Ensure they have an (empty) entry in the friend list
     //    This makes sure get_friends(userID) works correctly.
     if (adjList.find(userID) == adjList.end()) {
         adjList[userID] = {}; // Create an empty friend set for them
     }
+    record_change(GraphChange::ADD_USER, userID, -1);
+
+    // 4. Record it in the journal (tags follow the ID, as in the tag file)
+    string record = "U " + to_string(userID);
+    for (const string& tag : tags) {
+        record += " " + tag;
+    }
+    append_journal(record);
+}
+
+GraphSnapshot SocialNetwork::freeze() const {
+    if (mapped) return mapped->graph(); // shares the mapped arrays
+    return GraphSnapshot(*this);
+}
+
+uint64_t SocialNetwork::get_version() const {
+    return version;
+}
+
+bool SocialNetwork::changes_since(uint64_t sinceVersion, vector<GraphChange>& out) const {
+    out.clear();
+    if (sinceVersion == version) return true;
+
+    // Versions only grow, so scan back from the newest change
+    for (size_t i = history.size(); i-- > 0;) {
+        if (history[i].versionBefore == sinceVersion) {
+            out.assign(history.begin() + i, history.end());
+            return true;
+        }
+        if (history[i].versionBefore < sinceVersion) break;
+    }
+    return false;
+}
+
+shared_ptr<const GraphSnapshot> SocialNetwork::snapshot() const {
+    if (!frozen) {
+        frozen = make_shared<const GraphSnapshot>(*this);
+    }
+    return frozen;
 }
\ No newline at end of file
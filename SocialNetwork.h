@@ -7,11 +7,45 @@ using namespace std;
 #include <set>       // For std::set
 #include <utility>   // For std::pair
 #include <algorithm> // For std::min and std::max
+#include <memory>    // For std::shared_ptr
+#include <fstream>   // For the journal stream
+#include <thread>    // For background journal compaction
+#include <deque>     // For the recent-change history
+#include <cstdint>
+#include "TagDictionary.h"
+
+class GraphSnapshot; // Defined in GraphSnapshot.h
+
+// Throughput figures reported by load_data_parallel().
+struct IngestStats {
+    size_t bytes = 0;      // edge + tag file bytes read
+    size_t edges = 0;      // edge lines accepted
+    size_t tagLines = 0;   // tag lines accepted
+    int threads = 1;       // parser threads used
+    double seconds = 0.0;  // wall time for the whole load
+
+    double mb_per_second() const { return seconds > 0 ? bytes / 1e6 / seconds : 0.0; }
+    double edges_per_second() const { return seconds > 0 ? edges / seconds : 0.0; }
+};
+
+// One recorded mutation (see SocialNetwork::changes_since).
+struct GraphChange {
+    enum Kind { ADD_FRIENDSHIP, REMOVE_FRIENDSHIP, ADD_USER };
+    Kind kind;
+    int userA;
+    int userB;               // -1 for ADD_USER
+    uint64_t versionBefore;  // get_version() just before the change
+};
 
 class SocialNetwork {
 public:
     // --- Public Interface ---
 
+    SocialNetwork() = default;
+
+    //Waits for any background journal compaction to finish.
+    ~SocialNetwork();
+
     
     //Loads graph edges and user tags from data files.
     //edgeFile Path to the edge list file (e.g., "1 2").
@@ -20,11 +54,58 @@ public:
     void load_data(const string& edgeFile, const string& tagFile);
 
     
+    //Loads the network from a binary graph file (see GraphStore.h).
+    //The file is memory-mapped and the network is served straight from it:
+    //snapshot() is the mapped CSR, user_exists and get_degree read the arrays,
+    //and a user's friend or tag set is built the first time it is asked for.
+    //The editable hash sets are only built on the first mutation (or when a
+    //journal is replayed), and references returned before that point it
+    //invalidates.
+    //binFile Path to the .bin file.
+    //verifyPayload Check every section's checksum and indices before returning
+    //(O(file size)); only skip it for a file this program wrote itself.
+    //Returns false (leaving the network empty) if the file is missing or invalid.
+     
+    bool load_binary(const string& binFile, bool verifyPayload = true);
+
+    
+    //Fast path for load_data(): same files, same result.
+    //Each file is read into one buffer, split into newline-aligned chunks and
+    //parsed concurrently with std::from_chars (no per-line streams or strings).
+    //Edges are merged with a sort/dedup pass, then the friend sets are sized
+    //once and filled concurrently by user range. The sort, the per-user map
+    //entries and the tag sets are still built on one thread.
+    //threads Number of parser threads (0 = one per hardware thread).
+    //Returns byte/edge counts and timing so throughput can be compared.
+     
+    IngestStats load_data_parallel(const string& edgeFile, const string& tagFile, int threads = 0);
+
+    
     //Saves the current network state (edges and tags) back to the files.
      
     void save_data(const string& edgeFile, const string& tagFile) const;
 
     
+    //Turns on the append-only mutation journal (write-ahead log).
+    //Call before load_data / load_data_parallel / load_binary: each loader
+    //replays the journal on top of the base files, and from then on every
+    //add_user, add_friendship and remove_friendship is appended and flushed
+    //as it happens, so a crash does not lose unsaved edits.
+    //journalFile Path to the journal (created if missing).
+    //compactThreshold Journal records after which commit_changes() folds the
+    //journal into fresh base files.
+     
+    void enable_journal(const string& journalFile, size_t compactThreshold = 10000);
+
+    
+    //Makes all changes so far durable.
+    //With a journal this only flushes it (O(changes)); once the journal has
+    //grown past its threshold, the base files are rewritten in a background
+    //thread and the journal starts over. Without a journal it calls save_data().
+     
+    void commit_changes(const string& edgeFile, const string& tagFile);
+
+    
     //Adds an undirected friendship edge between two users.
      
     void add_friendship(int userA, int userB);
@@ -66,18 +147,77 @@ public:
     const unordered_set<string>& get_tags(int userID) const;
 
     
+    //Gets a user's tags as interned tag IDs (see tag_dictionary()).
+    //userID The user's ID.
+    //A const reference to the user's tag IDs, sorted ascending.
+    // Returns a static empty list if user does not exist or has no tags.
+     
+    const vector<int>& get_tag_ids(int userID) const;
+
+    
+    //Gets the users who have a tag (the inverted tag index).
+    //tagID An interned tag ID (see tag_dictionary()).
+    //A const reference to the tag's posting list of user IDs, in no particular order.
+    // Returns a static empty list if no user has the tag.
+     
+    const vector<int>& get_tag_users(int tagID) const;
+
+    
+    //Gets the global tag dictionary (tag string <-> tag ID).
+     
+    const TagDictionary& tag_dictionary() const;
+
+    
     //Gets a list of all users in the network.
      //A const reference to the set of all user IDs.
      
     const unordered_set<int>& get_all_users() const;
 
     
+    //Gets the number of users (cheaper than get_all_users().size() on a
+    //network loaded with load_binary, which builds that set on first use).
+     
+    size_t num_users() const;
+
+    
     //Gets the degree (friend count) of a user.
     //userID The user's ID.
      //The number of friends, or 0 if user does not exist.
      
     int get_degree(int userID) const;
 
+    
+    //Builds an immutable CSR snapshot of the current friendships.
+    //User IDs are remapped to dense indices so analytics can use flat arrays.
+    //The snapshot does not track later changes; freeze again after mutating.
+     
+    GraphSnapshot freeze() const;
+
+    
+    //Gets a shared CSR snapshot of the current friendships.
+    //Unlike freeze(), the snapshot is built once and reused until the next mutation.
+     
+    shared_ptr<const GraphSnapshot> snapshot() const;
+
+    
+    //Gets the graph's mutation version stamp.
+    //Every load, add_user, add_friendship and remove_friendship moves it to a
+    //new, process-wide unique value, so derived results (e.g. PageRankCache)
+    //can be keyed by it and reused for as long as it stays the same.
+     
+    uint64_t get_version() const;
+
+    
+    //Lists the mutations made since an earlier version, oldest first.
+    //Lets derived results (PageRank, communities, caches) update themselves
+    //incrementally instead of recomputing from scratch.
+    //version An earlier get_version() value.
+    //out Receives the changes (cleared first).
+    //Returns false if the history does not reach back that far (e.g. the
+    //version predates the last load, or too many changes were made since).
+     
+    bool changes_since(uint64_t version, vector<GraphChange>& out) const;
+
 private:
     // --- Private Data Members ---
     
@@ -88,7 +228,47 @@ private:
     // Master list of all users
     unordered_set<int> allUserIDs;
 
+    // Interned copy of userTags: sorted tag IDs per user (kept in sync by index_tags)
+    TagDictionary tagDictionary;
+    unordered_map<int, vector<int>> userTagIDs;
+
+    // Inverted tag index: tag ID -> users with that tag (kept in sync by index_tags)
+    vector<vector<int>> tagPostings;
+
+    // Cached CSR snapshot (reset by every mutation, rebuilt lazily by snapshot())
+    mutable shared_ptr<const GraphSnapshot> frozen;
+
+    // Binary graph the read accessors are served from after load_binary, until
+    // the first mutation copies it into the hash sets above (see materialize)
+    struct MappedView;
+    shared_ptr<MappedView> mapped;
+
+    // Mutation version stamp (see get_version)
+    uint64_t version = 0;
+
+    // Bounded history of recent mutations (see changes_since)
+    deque<GraphChange> history;
+    static const size_t MAX_HISTORY = 4096;
+
+    // --- Mutation journal (see enable_journal) ---
+    string journalPath;            // empty = journal disabled
+    ofstream journalStream;
+    size_t journalRecords = 0;     // records appended since the last compaction
+    size_t journalThreshold = 10000;
+    thread compactor;              // background base-file rewrite, if running
+
+    void materialize();
+    void mark_changed();
+    void record_change(GraphChange::Kind kind, int userA, int userB);
+    void reset_graph();
+    void index_tags(int userID);
+    void index_all_tags();
+    void replay_journal();
+    void append_journal(const string& record);
+    void wait_for_compaction();
+
     // Static empty sets to return for non-existent users (safe getter)
     static const unordered_set<int> EMPTY_FRIEND_SET;
     static const unordered_set<string> EMPTY_TAG_SET;
+    static const vector<int> EMPTY_TAG_ID_LIST;
 };
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+using namespace std;
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+//Global tag dictionary: maps each distinct tag string to a small integer ID.
+//IDs are handed out densely (0, 1, 2, ...) in first-seen order and never reused,
+//so per-user tag sets can be stored as sorted int arrays and compared without
+//hashing strings.
+class TagDictionary {
+public:
+    //Gets the ID of a tag, assigning the next free ID if it is new.
+    int intern(const string& tag) {
+        auto [it, inserted] = ids.emplace(tag, static_cast<int>(names.size()));
+        if (inserted) names.push_back(tag);
+        return it->second;
+    }
+
+    //Gets the ID of a tag, or -1 if the tag has never been seen.
+    int find(const string& tag) const {
+        auto it = ids.find(tag);
+        return it == ids.end() ? -1 : it->second;
+    }
+
+    //Gets the text of a tag by ID.
+    const string& name(int tagID) const { return names[tagID]; }
+
+    //Number of distinct tags (valid IDs are 0 .. size() - 1).
+    int size() const { return static_cast<int>(names.size()); }
+
+    void clear() {
+        ids.clear();
+        names.clear();
+    }
+
+private:
+    unordered_map<string, int> ids;
+    vector<string> names;
+};
@@ -31,7 +31,19 @@ public:
         out << "  },\n";
         
         // --- Calculate PageRank for all users ---
-        unordered_map<int, double> pagerank_scores = calculate_pagerank(network, 0.85, 100, false);
+        // (shared with the recommenders; only recomputed if the graph changed)
+        auto pagerank = PageRankCache::shared().get(network);
+        const unordered_map<int, double>& pagerank_scores = pagerank->by_user();
+        const PageRankStats& pagerankStats = pagerank->stats;
+        if (pagerankStats.incremental) {
+            cout << "PageRank: updated with " << pagerankStats.pushes << " pushes, residual ";
+        } else {
+            cout << "PageRank: " << pagerankStats.iterations << " iterations, residual ";
+        }
+        cout << pagerankStats.residual << (pagerankStats.converged ? " (converged)" : "");
+        if (pagerankStats.fallback) cout << " (full run: " << pagerankStats.fallback << ")";
+        cout << "; cache " << PageRankCache::shared().hits() << " hits / "
+             << PageRankCache::shared().misses() << " misses" << endl;
         
         // --- 1. Export Nodes ---
         out << "  nodes: [\n";
@@ -105,7 +117,8 @@ public:
         for (int userID : users) {
             const auto& tags = network.get_tags(userID);
             const auto& friends = network.get_friends(userID);
-            double pagerank = pagerank_scores.count(userID) ? pagerank_scores[userID] : 0.0;
+            auto rankIt = pagerank_scores.find(userID);
+            double userRank = rankIt != pagerank_scores.end() ? rankIt->second : 0.0;
             
             out << "    " << userID << ": {\n";
             out << "      id: " << userID << ",\n";
@@ -130,7 +143,7 @@ public:
             out << "],\n";
             
             out << "      friendCount: " << friends.size() << ",\n";
-            out << "      pagerank: " << pagerank << "\n";
+            out << "      pagerank: " << userRank << "\n";
             out << "    }";
             
             if (++counter < totalUsers) out << ",";
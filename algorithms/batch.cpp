@@ -0,0 +1,118 @@
+#include "batch.h"
+#include "influence.h"
+#include "proximity.h"
+#include "hybrid.h"
+#include "pagerank.h"
+#include "workspace.h"
+#include "../Parallel.h"
+#include <fstream>
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <algorithm>
+
+using namespace std;
+
+// Users are handed out to threads in blocks of this size
+static const int USER_BLOCK = 64;
+
+bool parse_recommend_algorithm(const string& name, RecommendAlgorithm& out) {
+    if (name == "influence") out = RecommendAlgorithm::INFLUENCE;
+    else if (name == "proximity") out = RecommendAlgorithm::PROXIMITY;
+    else if (name == "hybrid") out = RecommendAlgorithm::HYBRID;
+    else return false;
+    return true;
+}
+
+vector<vector<int>> recommend_batch(const SocialNetwork& network, const vector<int>& users,
+                                    const BatchOptions& options, BatchStats* stats) {
+    auto startTime = chrono::steady_clock::now();
+    bool useInfluence = options.algorithm != RecommendAlgorithm::PROXIMITY;
+
+    // --- 1. Shared, read-only inputs (fetched once for the whole batch) ---
+    shared_ptr<const PageRankResult> pagerank;
+    shared_ptr<const GraphSnapshot> graphPtr;
+    if (useInfluence) {
+        pagerank = PageRankCache::shared().get(network);
+        graphPtr = pagerank->graph; // PageRank's dense indices are this snapshot's
+    } else {
+        graphPtr = network.snapshot();
+    }
+    const GraphSnapshot& graph = *graphPtr;
+
+    // Tags per user, and the inverted index (tag -> users) in dense indices
+    shared_ptr<const DenseTagIndex> tags;
+    if (useInfluence) tags = make_shared<DenseTagIndex>(network, graph);
+
+    // --- 2. Users in blocks across threads ---
+    vector<vector<int>> results(users.size());
+    int numBlocks = (static_cast<int>(users.size()) + USER_BLOCK - 1) / USER_BLOCK;
+    int T = max(1, min(resolve_thread_count(options.threads), numBlocks));
+    atomic<int> next_block(0);
+
+    run_in_parallel(T, [&](int) {
+        QueryWorkspace& ws = QueryWorkspace::local();
+
+        while (true) {
+            int block = next_block.fetch_add(1);
+            if (block >= numBlocks) break;
+            size_t first = static_cast<size_t>(block) * USER_BLOCK;
+            size_t last = min(users.size(), first + USER_BLOCK);
+
+            for (size_t i = first; i < last; ++i) {
+                int userID = users[i];
+                if (start_recommendation_query(network, graph, userID, ws) == -1) continue;
+
+                // --- The interactive recommenders' own scorers, minus the logging ---
+                const vector<pair<double, int>>* best;
+                if (options.algorithm == RecommendAlgorithm::INFLUENCE) {
+                    score_influence(network, *pagerank, userID, 1.0, ws, tags.get());
+                    best = &ws.top_k(options.top_k);
+                } else if (options.algorithm == RecommendAlgorithm::PROXIMITY) {
+                    score_proximity(graph, 1.0, ws);
+                    best = &ws.top_k(options.top_k);
+                } else {
+                    best = &score_hybrid(network, *pagerank, userID, options.top_k,
+                                         options.w_influence, options.w_proximity, ws, nullptr, tags.get());
+                }
+
+                vector<int>& out = results[i];
+                out.reserve(best->size());
+                for (const auto& [score, c] : *best) {
+                    out.push_back(graph.user_id(c));
+                }
+            }
+        }
+    });
+
+    if (stats) {
+        stats->users = users.size();
+        stats->threads = T;
+        stats->seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    }
+    return results;
+}
+
+bool write_recommendations_tsv(const string& path, const vector<int>& users, const vector<vector<int>>& recommendations) {
+    ofstream out(path);
+    if (!out.is_open()) {
+        cerr << "  Error: Could not open " << path << " for writing." << endl;
+        return false;
+    }
+    out << "user\trecommendations\n";
+    for (size_t i = 0; i < users.size(); ++i) {
+        out << users[i] << '\t';
+        for (size_t r = 0; r < recommendations[i].size(); ++r) {
+            if (r > 0) out << ',';
+            out << recommendations[i][r];
+        }
+        out << '\n';
+    }
+    out.close();
+    if (!out) {
+        cerr << "  Error: Failed while writing " << path << "." << endl;
+        return false;
+    }
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+using namespace std;
+#include "../SocialNetwork.h"
+#include <vector>
+#include <string>
+
+
+//Which recommender a batch job runs (same scoring as the interactive ones).
+enum class RecommendAlgorithm { INFLUENCE, PROXIMITY, HYBRID };
+
+//Parses "influence", "proximity" or "hybrid". Returns false if unknown.
+bool parse_recommend_algorithm(const string& name, RecommendAlgorithm& out);
+
+
+//Settings for one batch run.
+struct BatchOptions {
+    RecommendAlgorithm algorithm = RecommendAlgorithm::HYBRID;
+    int top_k = 5;
+    double w_influence = 0.5; // hybrid only
+    double w_proximity = 0.5; // hybrid only
+    int threads = 0;          // 0 = one per hardware thread
+};
+
+//Throughput report for one batch run.
+struct BatchStats {
+    size_t users = 0;
+    int threads = 0;
+    double seconds = 0.0;
+
+    double users_per_second() const { return seconds > 0 ? users / seconds : 0.0; }
+};
+
+
+//Computes top-k recommendations for many users at once ("people you may know").
+//Returns exactly what recommend_by_influence / _proximity / _hybrid would for
+//each user, but PageRank and the graph are fetched once, users are spread
+//over threads, each thread reuses its own dense score arrays, and nothing is
+//written to LogManager.
+//network The populated SocialNetwork object (must not change during the call).
+//users The users to process (unknown IDs get an empty list).
+//Returns one recommendation list per entry of 'users', in the same order.
+ 
+vector<vector<int>> recommend_batch(
+    const SocialNetwork& network,
+    const vector<int>& users,
+    const BatchOptions& options,
+    BatchStats* stats = nullptr
+);
+
+
+//Writes batch results as a TSV table: one "userID<TAB>rec1,rec2,..." line per user.
+//Returns true on success.
+ 
+bool write_recommendations_tsv(const string& path, const vector<int>& users, const vector<vector<int>>& recommendations);
\ No newline at end of file
@@ -1,13 +1,141 @@
 #include "betweenness.h"
 #include "../LogManager.h"
-#include <stack>
-#include <queue>
+#include "../Parallel.h"
 #include <vector>
+#include <algorithm>
 #include <unordered_map>
+#include <random>
+#include <cmath>
 
 using namespace std;
 
-unordered_map<int, double> calculate_betweenness_scores(const SocialNetwork& network) {
+// Sources are dealt to threads in blocks of this size, round-robin
+static const int SOURCE_BLOCK = 16;
+
+// Path sampling: universal constant from Riondato & Kornaropoulos, batch sizing,
+// and how many unchanged batches count as a "stable" top-k ranking
+static const double SAMPLE_CONSTANT = 0.5;
+static const long long MIN_SAMPLE_BATCH = 1000;
+static const int SAMPLE_BATCHES = 20;
+static const int STABLE_BATCHES = 3;
+
+// Logs users with significant betweenness (top 30% of the maximum score)
+static void log_bridge_users(const unordered_map<int, double>& result) {
+    // Find max score for normalization
+    double maxScore = 0.0;
+    for (const auto& [user, score] : result) {
+        if (score > maxScore) maxScore = score;
+    }
+    
+    if (maxScore > 0) {
+        for (const auto& [user, score] : result) {
+            if (score >= maxScore * 0.3) {
+                LogManager::log("visit", user, -1, score);
+            }
+        }
+    }
+}
+
+// Upper bound on the number of vertices in any shortest path: one BFS per
+// connected component, whose diameter is at most twice the BFS depth.
+static int estimate_vertex_diameter(const GraphSnapshot& graph) {
+    int N = graph.num_users();
+    vector<int> distance(N, -1);
+    vector<int> bfsQueue(N);
+    int longest = 0;
+
+    for (int root = 0; root < N; ++root) {
+        if (distance[root] != -1) continue;
+        int head = 0, tail = 0;
+        distance[root] = 0;
+        bfsQueue[tail++] = root;
+        int depth = 0;
+        while (head < tail) {
+            int v = bfsQueue[head++];
+            depth = distance[v];
+            for (int w : graph.neighbors_of(v)) {
+                if (distance[w] == -1) {
+                    distance[w] = depth + 1;
+                    bfsQueue[tail++] = w;
+                }
+            }
+        }
+        longest = max(longest, 2 * depth);
+    }
+    return longest + 1;
+}
+
+namespace {
+
+// Per-thread scratch space for sampling shortest paths
+struct PathSampler {
+    const GraphSnapshot& graph;
+    vector<int> order;
+    vector<int> distance;
+    vector<double> pathCount;
+
+    explicit PathSampler(const GraphSnapshot& g)
+        : graph(g), order(g.num_users()), distance(g.num_users(), -1), pathCount(g.num_users(), 0.0) {}
+
+    // Picks one shortest path from 'source' to 'target' uniformly at random and
+    // adds 1 to hits[] for every vertex strictly inside it.
+    void sample(int source, int target, mt19937_64& rng, vector<long long>& hits) {
+        // --- 1. BFS from the source, stopping once the target's level is complete ---
+        int head = 0, tail = 0;
+        distance[source] = 0;
+        pathCount[source] = 1.0;
+        order[tail++] = source;
+
+        while (head < tail) {
+            int v = order[head++];
+            if (distance[target] != -1 && distance[v] >= distance[target]) break;
+            int next_level = distance[v] + 1;
+            for (int w : graph.neighbors_of(v)) {
+                if (distance[w] == -1) {
+                    distance[w] = next_level;
+                    order[tail++] = w;
+                }
+                if (distance[w] == next_level) {
+                    pathCount[w] += pathCount[v];
+                }
+            }
+        }
+
+        // --- 2. Walk back from the target, choosing each parent in proportion
+        //        to the number of shortest paths that run through it ---
+        if (distance[target] != -1) {
+            uniform_real_distribution<double> unit(0.0, 1.0);
+            int w = target;
+            while (w != source) {
+                int parent_level = distance[w] - 1;
+                double pick = unit(rng) * pathCount[w];
+                int chosen = -1;
+                for (int v : graph.neighbors_of(w)) {
+                    if (distance[v] != parent_level) continue;
+                    chosen = v;
+                    pick -= pathCount[v];
+                    if (pick < 0) break;
+                }
+                w = chosen;
+                if (w != source) hits[w]++;
+            }
+        }
+
+        // --- 3. Reset only what this sample touched ---
+        for (int i = 0; i < tail; ++i) {
+            distance[order[i]] = -1;
+            pathCount[order[i]] = 0.0;
+        }
+    }
+};
+
+}
+
+unordered_map<int, double> calculate_betweenness_scores(const SocialNetwork& network, int threads) {
+    return calculate_betweenness_scores(*network.snapshot(), threads);
+}
+
+unordered_map<int, double> calculate_betweenness_scores(const GraphSnapshot& graph, int threads) {
     
     // Clear logs and set algorithm info (no specific target user for centrality metrics)
     LogManager::clear();
@@ -17,105 +145,204 @@ unordered_map<int, double> calculate_betweenness_scores(const SocialNetwork& net
         -1  // No specific target user
     );
     
-    const auto& allUsers = network.get_all_users();
-    unordered_map<int, double> betweenness_scores;
-    
-    // Initialize scores for all users to 0.0
-    for (int userID : allUsers) {
-        betweenness_scores[userID] = 0.0;
-    }
+    int N = graph.num_users();
+    int T = max(1, min(resolve_thread_count(threads), (N + SOURCE_BLOCK - 1) / SOURCE_BLOCK));
+
+    // One score vector per thread (indexed by dense snapshot index), summed at the end
+    vector<vector<double>> partial_scores(T, vector<double>(N, 0.0));
 
     // --- Main Loop: Run this process from every user as a 'source' (s) ---
-    for (int s : allUsers) {
-        
-        // --- Pass 1: Forward BFS ---
-        // (This BFS counts shortest paths)
-        
-        stack<int> S; // Stores nodes in order of discovery for Pass 2
-        
-        // map: User -> List of its parents in the shortest path
-        unordered_map<int, vector<int>> predecessors;
-        // map: User -> Number of shortest paths from 's' to this user (use double to prevent overflow)
-        unordered_map<int, double> shortest_path_count;
-        // map: User -> Distance from 's'
-        unordered_map<int, int> distance;
-        
-        queue<int> Q;
-
-        // Initialize for the source node 's'
-        shortest_path_count[s] = 1;
-        distance[s] = 0;
-        Q.push(s);
-
-        while (!Q.empty()) {
-            int v = Q.front();
-            Q.pop();
-            S.push(v); // Add to stack for Pass 2
-
-            for (int w : network.get_friends(v)) {
-                
-                // Case 1: Neighbor 'w' has not been visited yet
-                if (distance.find(w) == distance.end()) {
-                    distance[w] = distance[v] + 1;
-                    Q.push(w);
-                }
+    // (thread t takes source blocks t, t + T, t + 2T, ...: a fixed assignment,
+    // so each thread adds up the same sources in the same order on every run
+    // and the scores do not depend on which thread finished first)
+    run_in_parallel(T, [&](int t) {
+        vector<double>& betweenness_scores = partial_scores[t];
 
-                // Case 2: 'w' is on a shortest path from 's'
-                if (distance[w] == distance[v] + 1) {
-                    // This path (v->w) is a shortest path
-                    shortest_path_count[w] += shortest_path_count[v];
-                    predecessors[w].push_back(v);
+        // Flat per-source scratch space, allocated once per thread and reset
+        // after each source. 'order' doubles as the BFS queue and, read
+        // backwards, as the Pass 2 stack. The predecessors of 'w' are the
+        // neighbors one level closer to 's', read straight from w's CSR row.
+        vector<int> order(N);
+        vector<double> shortest_path_count(N, 0.0); // Number of shortest paths from 's' (double prevents overflow)
+        vector<int> distance(N, -1);                // Distance from 's' (-1 = unvisited)
+        vector<double> dependency(N, 0.0);
+
+        for (int first = t * SOURCE_BLOCK; first < N; first += T * SOURCE_BLOCK) {
+            int last = min(N, first + SOURCE_BLOCK);
+
+            for (int s = first; s < last; ++s) {
+                // --- Pass 1: Forward BFS ---
+                // (This BFS counts shortest paths)
+                int head = 0, tail = 0;
+
+                // Initialize for the source node 's'
+                shortest_path_count[s] = 1;
+                distance[s] = 0;
+                order[tail++] = s;
+
+                while (head < tail) {
+                    int v = order[head++];
+                    int next_level = distance[v] + 1;
+
+                    for (int w : graph.neighbors_of(v)) {
+                        // Case 1: Neighbor 'w' has not been visited yet
+                        if (distance[w] == -1) {
+                            distance[w] = next_level;
+                            order[tail++] = w;
+                        }
+                        // Case 2: 'w' is on a shortest path from 's' (via v)
+                        if (distance[w] == next_level) {
+                            shortest_path_count[w] += shortest_path_count[v];
+                        }
+                    }
                 }
-            }
-        }
 
-        // --- Pass 2: Backward Propagation ---
-        // (This pass calculates the 'dependency' score)
-
-        unordered_map<int, double> dependency;
-        
-        // Go through the stack (farthest nodes first)
-        while (!S.empty()) {
-            int w = S.top();
-            S.pop();
-
-            // Loop through all parents 'v' of 'w'
-            for (int v : predecessors[w]) {
-                // Dependency = (paths_through_v / total_paths_to_w) * (1 + dependency_of_w)
-                double path_fraction = (double)shortest_path_count[v] / shortest_path_count[w];
-                dependency[v] += path_fraction * (1.0 + dependency[w]);
-            }
+                // --- Pass 2: Backward Propagation ---
+                // (This pass calculates the 'dependency' score)
+                // Go through the discovery order backwards (farthest nodes first)
+                for (int i = tail - 1; i > 0; --i) {
+                    int w = order[i];
+                    int parent_level = distance[w] - 1;
+                    double share = (1.0 + dependency[w]) / shortest_path_count[w];
+
+                    // Loop through all parents 'v' of 'w'
+                    for (int v : graph.neighbors_of(w)) {
+                        if (distance[v] == parent_level) {
+                            // Dependency = (paths_through_v / total_paths_to_w) * (1 + dependency_of_w)
+                            dependency[v] += shortest_path_count[v] * share;
+                        }
+                    }
+
+                    // Add this node's dependency score to its final betweenness score
+                    // (order[0] is the source 's' itself, which is skipped)
+                    betweenness_scores[w] += dependency[w];
+                }
 
-            // Add this node's dependency score to its final betweenness score
-            // (Don't add the score for the source node 's' itself)
-            if (w != s) {
-                betweenness_scores[w] += dependency[w];
+                // Reset the scratch space for the vertices this source reached
+                for (int i = 0; i < tail; ++i) {
+                    int w = order[i];
+                    shortest_path_count[w] = 0.0;
+                    distance[w] = -1;
+                    dependency[w] = 0.0;
+                }
             }
         }
-    }
+    });
 
     // --- Finalization ---
-    // The algorithm counts each path twice (A->B and B->A)
-    // For an undirected graph, we must divide all scores by 2.
-    for (auto& [user, score] : betweenness_scores) {
-        score /= 2.0;
+    // Reduce the per-thread scores, always in thread order. The algorithm counts each path twice
+    // (A->B and B->A), so for an undirected graph we divide all scores by 2.
+    unordered_map<int, double> result;
+    result.reserve(N);
+    for (int v = 0; v < N; ++v) {
+        double total = 0.0;
+        for (int t = 0; t < T; ++t) {
+            total += partial_scores[t][v];
+        }
+        result[graph.user_id(v)] = total / 2.0;
     }
     
-    // --- Log High Betweenness Users ---
-    // Find max score for normalization
-    double maxScore = 0.0;
-    for (const auto& [user, score] : betweenness_scores) {
-        if (score > maxScore) maxScore = score;
+    log_bridge_users(result);
+    return result;
+}
+
+unordered_map<int, double> approximate_betweenness_scores(const SocialNetwork& network, double epsilon, double delta,
+                                                          int topK, int threads, BetweennessApproxStats* stats, uint64_t seed) {
+    return approximate_betweenness_scores(*network.snapshot(), epsilon, delta, topK, threads, stats, seed);
+}
+
+unordered_map<int, double> approximate_betweenness_scores(const GraphSnapshot& graph, double epsilon, double delta,
+                                                          int topK, int threads, BetweennessApproxStats* stats, uint64_t seed) {
+    LogManager::clear();
+    LogManager::setAlgorithm(
+        "Approximate Betweenness Centrality",
+        "Estimating how often each user sits on shortest paths by sampling random shortest paths, stopping once the top bridge users stop changing.",
+        -1  // No specific target user
+    );
+
+    int N = graph.num_users();
+    BetweennessApproxStats report;
+    unordered_map<int, double> result;
+    result.reserve(N);
+    for (int v = 0; v < N; ++v) {
+        result[graph.user_id(v)] = 0.0;
     }
-    
-    // Log users with significant betweenness (top 30%)
-    if (maxScore > 0) {
-        for (const auto& [user, score] : betweenness_scores) {
-            if (score >= maxScore * 0.3) {
-                LogManager::log("visit", user, -1, score);
+
+    // --- 1. Sample budget from the vertex diameter (VD) ---
+    // r = (c / epsilon^2) * (floor(log2(VD - 2)) + 1 + ln(1 / delta))
+    // A path with fewer than 3 vertices has no interior, so every score is 0.
+    report.vertexDiameter = N > 0 ? estimate_vertex_diameter(graph) : 0;
+    if (N < 3 || report.vertexDiameter < 3) {
+        if (stats) *stats = report;
+        return result;
+    }
+    double complexity = floor(log2(report.vertexDiameter - 2.0)) + 1.0 + log(1.0 / delta);
+    report.sampleBudget = static_cast<long long>(ceil(SAMPLE_CONSTANT / (epsilon * epsilon) * complexity));
+
+    // --- 2. Sample in batches until the budget is spent or the top-k settles ---
+    int T = max(1, resolve_thread_count(threads));
+    long long batchSize = max(MIN_SAMPLE_BATCH, (report.sampleBudget + SAMPLE_BATCHES - 1) / SAMPLE_BATCHES);
+    topK = min(topK, N);
+
+    vector<vector<long long>> partial_hits(T, vector<long long>(N, 0));
+    vector<long long> hits(N, 0);
+    vector<int> ranking(N), previousTop;
+    int stableBatches = 0;
+
+    for (long long batch = 0; report.samples < report.sampleBudget; ++batch) {
+        long long batchSamples = min(batchSize, report.sampleBudget - report.samples);
+
+        run_in_parallel(T, [&](int t) {
+            // Each thread draws its own share with its own seeded generator,
+            // so the result only depends on the seed and the thread count.
+            long long share = batchSamples / T + (t < batchSamples % T ? 1 : 0);
+            seed_seq seq{seed, static_cast<uint64_t>(batch), static_cast<uint64_t>(t)};
+            mt19937_64 rng(seq);
+            uniform_int_distribution<int> pickSource(0, N - 1);
+            uniform_int_distribution<int> pickTarget(0, N - 2);
+            PathSampler sampler(graph);
+
+            vector<long long>& threadHits = partial_hits[t];
+            fill(threadHits.begin(), threadHits.end(), 0);
+            for (long long i = 0; i < share; ++i) {
+                int source = pickSource(rng);
+                int target = pickTarget(rng);
+                if (target >= source) ++target; // uniform over targets != source
+                sampler.sample(source, target, rng, threadHits);
+            }
+        });
+
+        for (int t = 0; t < T; ++t) {
+            for (int v = 0; v < N; ++v) {
+                hits[v] += partial_hits[t][v];
             }
         }
+        report.samples += batchSamples;
+
+        // Is the top-k (in order) the same as after the previous batch?
+        if (topK <= 0) continue;
+        for (int v = 0; v < N; ++v) ranking[v] = v;
+        partial_sort(ranking.begin(), ranking.begin() + topK, ranking.end(), [&](int a, int b) {
+            return hits[a] != hits[b] ? hits[a] > hits[b] : a < b;
+        });
+        vector<int> currentTop(ranking.begin(), ranking.begin() + topK);
+        stableBatches = (currentTop == previousTop) ? stableBatches + 1 : 0;
+        previousTop = std::move(currentTop);
+        if (stableBatches >= STABLE_BATCHES && report.samples < report.sampleBudget) {
+            report.stoppedEarly = true;
+            break;
+        }
+    }
+
+    // --- 3. Scale hit frequencies to exact-betweenness units ---
+    // A hit frequency estimates score / (N(N-1)/2), the normalized betweenness.
+    report.errorBound = sqrt(SAMPLE_CONSTANT * complexity / report.samples);
+    double scale = (static_cast<double>(N) * (N - 1) / 2.0) / report.samples;
+    for (int v = 0; v < N; ++v) {
+        result[graph.user_id(v)] = hits[v] * scale;
     }
 
-    return betweenness_scores;
+    log_bridge_users(result);
+    if (stats) *stats = report;
+    return result;
 }
\ No newline at end of file
@@ -2,12 +2,72 @@
 
 using namespace std;
 #include "../SocialNetwork.h"
+#include "../GraphSnapshot.h"
 #include <unordered_map>
 #include <vector>
+#include <cstdint>
 
 
 //Calculates the Betweenness Centrality score for every user.
+//Sources are split between threads in a fixed pattern, so the same thread
+//count gives bit-identical scores on every run. Different thread counts add
+//the per-source terms in a different order and agree up to floating-point
+//rounding (about 1e-12 relative).
 //network: The populated SocialNetwork object.
+//threads: Worker threads for the per-source passes (0 = one per hardware thread).
 //Returns an unordered_map<int, double> mapping UserID to its Betweenness Score.
  
-unordered_map<int, double> calculate_betweenness_scores(const SocialNetwork& network);
\ No newline at end of file
+unordered_map<int, double> calculate_betweenness_scores(const SocialNetwork& network, int threads = 0);
+
+
+//Same as above, but runs directly on a frozen CSR snapshot of the network.
+ 
+unordered_map<int, double> calculate_betweenness_scores(const GraphSnapshot& graph, int threads = 0);
+
+
+//Report for one approximate betweenness run.
+struct BetweennessApproxStats {
+    long long samples = 0;      // shortest paths actually sampled
+    long long sampleBudget = 0; // samples needed for the requested epsilon / delta
+    int vertexDiameter = 0;     // upper bound on the vertices in any shortest path
+    double errorBound = 0.0;    // epsilon guaranteed by the samples taken (normalized scale)
+    bool stoppedEarly = false;  // true if the top-k ranking settled before the budget ran out
+};
+
+
+//Estimates Betweenness Centrality by sampling random shortest paths
+//(Riondato & Kornaropoulos): each sample picks a random pair of users, picks one
+//of their shortest paths uniformly, and credits the users strictly inside it.
+//With the full sample budget, every normalized score is within epsilon of the
+//exact value with probability at least 1 - delta. Sampling stops earlier once
+//the top-k users (in order) stay the same for several consecutive batches.
+//Scores are scaled to the same units as calculate_betweenness_scores.
+//epsilon Additive error on the normalized scale (score / (N(N-1)/2)).
+//delta Allowed failure probability.
+//topK How many top users must be stable before stopping early (0 = never stop early).
+//threads Worker threads (0 = one per hardware thread).
+//stats If non-null, receives the sample count and the error actually achieved.
+//seed Seed for the path sampler (runs with the same seed and thread count repeat exactly).
+ 
+unordered_map<int, double> approximate_betweenness_scores(
+    const SocialNetwork& network,
+    double epsilon = 0.01,
+    double delta = 0.1,
+    int topK = 5,
+    int threads = 0,
+    BetweennessApproxStats* stats = nullptr,
+    uint64_t seed = 42
+);
+
+
+//Same as above, but runs directly on a frozen CSR snapshot of the network.
+ 
+unordered_map<int, double> approximate_betweenness_scores(
+    const GraphSnapshot& graph,
+    double epsilon = 0.01,
+    double delta = 0.1,
+    int topK = 5,
+    int threads = 0,
+    BetweennessApproxStats* stats = nullptr,
+    uint64_t seed = 42
+);
\ No newline at end of file
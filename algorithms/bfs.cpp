@@ -8,7 +8,56 @@
 
 using namespace std;
 
-vector<int> get_shortest_path(const SocialNetwork& network, int startUser, int endUser) {
+namespace {
+
+// One side of a bidirectional search: its current BFS level and the parent of
+// every user it has reached (the side's own root maps to -1).
+struct SearchSide {
+    vector<int> frontier;
+    unordered_map<int, int> parent_map;
+    long long frontierDegree = 0; // sum of friend counts over the frontier
+
+    explicit SearchSide(const SocialNetwork& network, int root) {
+        frontier.push_back(root);
+        parent_map[root] = -1;
+        frontierDegree = network.get_degree(root);
+    }
+};
+
+// Expands one full level of 'side'. Returns a user reached by both sides, or -1.
+// Because levels are expanded whole and the search stops at the first meeting,
+// every meeting user found here lies on a shortest path.
+int expand_level(const SocialNetwork& network, SearchSide& side, const SearchSide& other) {
+    vector<int> nextFrontier;
+    long long nextDegree = 0;
+
+    for (int currentUser : side.frontier) {
+        // LOG: We are now processing this node (the "ripple" expands from here)
+        LogManager::log("visit", currentUser);
+
+        for (int neighbor : network.get_friends(currentUser)) {
+            if (side.parent_map.count(neighbor)) continue;
+            side.parent_map[neighbor] = currentUser;
+
+            // LOG: We found a new neighbor to look at later
+            LogManager::log("scan", neighbor);
+
+            if (other.parent_map.count(neighbor)) {
+                return neighbor;
+            }
+            nextFrontier.push_back(neighbor);
+            nextDegree += network.get_degree(neighbor);
+        }
+    }
+
+    side.frontier.swap(nextFrontier);
+    side.frontierDegree = nextDegree;
+    return -1;
+}
+
+}
+
+vector<int> get_shortest_path_unidirectional(const SocialNetwork& network, int startUser, int endUser) {
     // 1. CLEAR previous logs before starting and set algorithm info
     LogManager::clear();
     LogManager::setAlgorithm(
@@ -68,5 +117,56 @@ vector<int> get_shortest_path(const SocialNetwork& network, int startUser, int e
         reverse(path.begin(), path.end());
     }
     
+    return path;
+}
+
+vector<int> get_shortest_path(const SocialNetwork& network, int startUser, int endUser) {
+    // 1. CLEAR previous logs before starting and set algorithm info
+    LogManager::clear();
+    LogManager::setAlgorithm(
+        "Shortest Path (Bidirectional BFS)",
+        "Finding shortest path using two Breadth-First Searches, one from each user. The smaller search grows one level at a time until the two meet in the middle.",
+        startUser
+    );
+
+    if (startUser == endUser) return {startUser};
+    if (!network.user_exists(startUser) || !network.user_exists(endUser)) return {};
+
+    SearchSide forward(network, startUser);
+    SearchSide backward(network, endUser);
+
+    // LOG: Starting the search from both ends
+    LogManager::log("visit", startUser);
+    LogManager::log("visit", endUser);
+
+    // 2. Grow the cheaper side (fewer users in its frontier, then fewer edges to scan)
+    int meeting = -1;
+    while (meeting == -1 && !forward.frontier.empty() && !backward.frontier.empty()) {
+        bool expandForward = forward.frontier.size() != backward.frontier.size()
+            ? forward.frontier.size() < backward.frontier.size()
+            : forward.frontierDegree <= backward.frontierDegree;
+        meeting = expandForward ? expand_level(network, forward, backward)
+                                : expand_level(network, backward, forward);
+    }
+
+    vector<int> path;
+    if (meeting == -1) return path;
+
+    // 3. Stitch the path: start .. meeting from the forward parents,
+    //    then meeting .. end from the backward parents
+    for (int current = meeting; current != -1; current = forward.parent_map[current]) {
+        path.push_back(current);
+    }
+    reverse(path.begin(), path.end());
+    for (int current = backward.parent_map[meeting]; current != -1; current = backward.parent_map[current]) {
+        path.push_back(current);
+    }
+
+    // LOG: Record the final path nodes so we can color them Gold later
+    // (end to start, the same order as the one-sided search)
+    for (auto it = path.rbegin(); it != path.rend(); ++it) {
+        LogManager::log("path", *it);
+    }
+
     return path;
 }
\ No newline at end of file
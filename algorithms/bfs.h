@@ -4,11 +4,20 @@
 #include <vector>
 
 
-//Finds the shortest path between two users using BFS.
+//Finds the shortest path between two users using bidirectional BFS.
+//Two searches run level by level, one from each end, always expanding the
+//smaller frontier, and stop as soon as they meet; on large networks this
+//visits far fewer users than a single search from the start.
 //network The populated SocialNetwork object.
 //startUser The user ID to start the search from.
 //endUser The user ID to find a path to.
 //Returns a std::vector<int> representing the path from start to end.
 //If no path is found, returns an empty vector.
 
-vector<int> get_shortest_path(const SocialNetwork& network, int startUser, int endUser);
\ No newline at end of file
+vector<int> get_shortest_path(const SocialNetwork& network, int startUser, int endUser);
+
+
+//Same result as get_shortest_path, using a classic one-sided BFS from startUser.
+//Kept as the reference for benchmarks (./recommender --bench-path).
+
+vector<int> get_shortest_path_unidirectional(const SocialNetwork& network, int startUser, int endUser);
\ No newline at end of file
@@ -1,12 +1,28 @@
 #include "closeness.h"
 #include "../LogManager.h"
-#include <queue>
+#include "../Parallel.h"
+#include "msbfs.h"
+#include <vector>
 #include <limits>
 #include <cmath>
+#include <atomic>
+#include <algorithm>
 
 using namespace std;
 
-unordered_map<int, double> calculate_closeness_scores(const SocialNetwork& network) {
+// Closeness formula shared by the exact score and the pruning bound, so a bound
+// that turns out to be tight compares equal to the exact score.
+static double closeness_from(int reachable, long long sum_of_distances, int N) {
+    double rawCloseness = (double)reachable / sum_of_distances;
+    double connectivityRatio = (double)reachable / (N - 1);
+    return rawCloseness * connectivityRatio;
+}
+
+unordered_map<int, double> calculate_closeness_scores(const SocialNetwork& network, int threads) {
+    return calculate_closeness_scores(*network.snapshot(), threads);
+}
+
+unordered_map<int, double> calculate_closeness_scores(const GraphSnapshot& graph, int threads) {
     
     // Clear logs and set algorithm info
     LogManager::clear();
@@ -16,55 +32,56 @@ unordered_map<int, double> calculate_closeness_scores(const SocialNetwork& netwo
         -1  // No specific target user
     );
     
-    const auto& allUsers = network.get_all_users();
-    int N = allUsers.size();
+    int N = graph.num_users();
     if (N <= 1) return {};
 
-    unordered_map<int, double> scores;
+    // --- Loop 1: BFS from every single user (All-Pairs-Shortest-Path) ---
+    // Sources run 64 at a time through the multi-source BFS, so each edge is
+    // scanned once per batch instead of once per source. Batches are handed
+    // out to threads; each source's totals land in its own slot.
+    vector<long long> sum_of_distances(N, 0);
+    vector<int> reachable_nodes(N, 0);
+
+    const int width = MultiSourceBFS::BATCH_WIDTH;
+    int numBatches = (N + width - 1) / width;
+    int T = max(1, min(resolve_thread_count(threads), numBatches));
+    atomic<int> next_batch(0);
 
-    // --- Loop 1: Run BFS from every single user (All-Pairs-Shortest-Path) ---
-    for (int startUser : allUsers) {
-        
-        // 1. Setup BFS for distance calculation
-        queue<int> q;
-        // map<UserID, DistanceFromStartNode>
-        unordered_map<int, int> distance; 
-        
-        q.push(startUser);
-        distance[startUser] = 0;
-        
-        int sum_of_distances = 0;
-        int reachable_nodes = 0;
-
-        // 2. Run the BFS
-        while (!q.empty()) {
-            int currentUser = q.front();
-            q.pop();
-
-            // Add this node's distance to the total sum
-            sum_of_distances += distance[currentUser];
-            
-            // Check neighbors
-            for (int neighbor : network.get_friends(currentUser)) {
-                // If distance map does not contain the neighbor, it's unvisited
-                if (distance.find(neighbor) == distance.end()) {
-                    distance[neighbor] = distance[currentUser] + 1;
-                    q.push(neighbor);
-                    reachable_nodes++;
+    run_in_parallel(T, [&](int t) {
+        MultiSourceBFS bfs(graph);
+        vector<int> sources(width);
+
+        while (true) {
+            int batch = next_batch.fetch_add(1);
+            if (batch >= numBatches) break;
+            int first = batch * width;
+            int count = min(width, N - first);
+            for (int i = 0; i < count; ++i) sources[i] = first + i;
+
+            bfs.run(sources.data(), count, [&](int vertex, int level, uint64_t reached) {
+                if (level == 0) return; // the source itself
+                // Credit this vertex to every source (bit) that just reached it
+                while (reached) {
+                    int start = first + __builtin_ctzll(reached);
+                    sum_of_distances[start] += level;
+                    reachable_nodes[start]++;
+                    reached &= reached - 1;
                 }
-            }
+            });
         }
-        
-        // --- 3. Calculate Closeness Score (Handle disconnected components) ---
+    });
+
+    unordered_map<int, double> scores;
+    for (int start = 0; start < N; ++start) {
+        // --- Calculate Closeness Score (Handle disconnected components) ---
         // Use the actual number of reachable nodes, not the total network size
         // This prevents isolated users from getting artificially high scores
-        if (sum_of_distances > 0 && reachable_nodes > 0) {
+        int startUser = graph.user_id(start);
+        if (sum_of_distances[start] > 0 && reachable_nodes[start] > 0) {
             // Closeness = (reachable_nodes) / sum of distances to reachable nodes
             // Normalized by total network size to penalize disconnected components
-            double rawCloseness = (double)reachable_nodes / sum_of_distances;
-            // Apply penalty for not reaching all nodes
-            double connectivityRatio = (double)reachable_nodes / (N - 1);
-            scores[startUser] = rawCloseness * connectivityRatio;
+            // (then a penalty for not reaching all nodes: * reachable_nodes / (N - 1))
+            scores[startUser] = closeness_from(reachable_nodes[start], sum_of_distances[start], N);
         } else {
             // Isolated node or error
             scores[startUser] = 0.0;
@@ -88,4 +105,156 @@ unordered_map<int, double> calculate_closeness_scores(const SocialNetwork& netwo
     }
     
     return scores;
+}
+
+vector<pair<int, double>> top_k_closeness(const SocialNetwork& network, int k, bool degreeOrder,
+                                          ClosenessTopKStats* stats) {
+    return top_k_closeness(*network.snapshot(), k, degreeOrder, stats);
+}
+
+vector<pair<int, double>> top_k_closeness(const GraphSnapshot& graph, int k, bool degreeOrder,
+                                          ClosenessTopKStats* stats) {
+    LogManager::clear();
+    LogManager::setAlgorithm(
+        "Closeness Centrality (Top-k)",
+        "Finding the best-connected users by running BFS from each user, abandoning a search as soon as it can no longer beat the current top users.",
+        -1  // No specific target user
+    );
+
+    int N = graph.num_users();
+    ClosenessTopKStats report;
+    if (N <= 1 || k <= 0) {
+        if (stats) *stats = report;
+        return {};
+    }
+
+    vector<int> distance(N, -1);
+    vector<int> bfsQueue(N);
+
+    // --- 1. Component sizes: a source in a component of size c reaches exactly c - 1 users ---
+    vector<int> reachable(N, 0);
+    for (int root = 0; root < N; ++root) {
+        if (distance[root] != -1) continue;
+        int head = 0, tail = 0;
+        distance[root] = 0;
+        bfsQueue[tail++] = root;
+        while (head < tail) {
+            int v = bfsQueue[head++];
+            for (int w : graph.neighbors_of(v)) {
+                if (distance[w] == -1) {
+                    distance[w] = 0;
+                    bfsQueue[tail++] = w;
+                }
+            }
+        }
+        for (int i = 0; i < tail; ++i) {
+            reachable[bfsQueue[i]] = tail - 1;
+        }
+    }
+    fill(distance.begin(), distance.end(), -1);
+
+    // --- 2. Source order (highest degree first, if requested) ---
+    vector<int> order(N);
+    for (int v = 0; v < N; ++v) order[v] = v;
+    if (degreeOrder) {
+        stable_sort(order.begin(), order.end(), [&](int a, int b) {
+            return graph.degree(a) > graph.degree(b);
+        });
+    }
+
+    // The current top k as a min-heap: the front is the k-th best (lowest score,
+    // then highest UserID), i.e. the entry the next better user would replace.
+    auto worse = [](const pair<double, int>& a, const pair<double, int>& b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    };
+    vector<pair<double, int>> best; // (score, UserID)
+    auto offer = [&](double score, int userID) {
+        pair<double, int> entry = {score, userID};
+        if ((int)best.size() < k) {
+            best.push_back(entry);
+            push_heap(best.begin(), best.end(), worse);
+        } else if (worse(entry, best.front())) {
+            pop_heap(best.begin(), best.end(), worse);
+            best.back() = entry;
+            push_heap(best.begin(), best.end(), worse);
+        }
+    };
+
+    // --- 3. One BFS per source, cut short once it cannot make the top k ---
+    for (int start : order) {
+        int r = reachable[start];
+        if (r == 0) {
+            offer(0.0, graph.user_id(start)); // Isolated node
+            report.sourcesExplored++;
+            continue;
+        }
+
+        int head = 0, tail = 0;
+        bfsQueue[tail++] = start;
+        distance[start] = 0;
+
+        long long sum_of_distances = 0;
+        int reached = 0;
+        int level = 0;
+        int levelEnd = 1;           // queue position where the current level ends
+        long long frontierCap = 0;  // upper bound on users one level past the newest one
+        bool pruned = false;
+
+        while (head < tail && reached < r) {
+            int current = bfsQueue[head++];
+            report.verticesVisited++;
+
+            for (int neighbor : graph.neighbors_of(current)) {
+                if (distance[neighbor] == -1) {
+                    distance[neighbor] = distance[current] + 1;
+                    bfsQueue[tail++] = neighbor;
+                    sum_of_distances += distance[neighbor];
+                    reached++;
+                    // Each of its other edges may lead to one new user on the next level
+                    frontierCap += graph.degree(neighbor) - 1;
+                }
+            }
+
+            if (head == levelEnd) {
+                // Level 'level + 1' is now complete. Every user not reached yet is
+                // at least 'level + 2' hops away, and at most 'frontierCap' of them
+                // can be exactly that close; the rest are 'level + 3' or more.
+                if ((int)best.size() == k && reached < r) {
+                    long long remaining = r - reached;
+                    long long nearest = min(frontierCap, remaining);
+                    long long lowerSum = sum_of_distances + (level + 2) * nearest +
+                                         (long long)(level + 3) * (remaining - nearest);
+                    if (closeness_from(r, lowerSum, N) < best.front().first) {
+                        pruned = true;
+                        break;
+                    }
+                }
+                levelEnd = tail;
+                frontierCap = 0;
+                level++;
+            }
+        }
+
+        for (int i = 0; i < tail; ++i) {
+            distance[bfsQueue[i]] = -1;
+        }
+
+        if (pruned) {
+            report.sourcesPruned++;
+        } else {
+            report.sourcesExplored++;
+            offer(closeness_from(r, sum_of_distances, N), graph.user_id(start));
+        }
+    }
+
+    // --- 4. Best first ---
+    sort_heap(best.begin(), best.end(), worse);
+    vector<pair<int, double>> result;
+    for (const auto& [score, userID] : best) {
+        result.push_back({userID, score});
+        LogManager::log("visit", userID, -1, score);
+    }
+
+    if (stats) *stats = report;
+    return result;
 }
\ No newline at end of file
@@ -2,12 +2,48 @@
 
 using namespace std;
 #include "../SocialNetwork.h"
+#include "../GraphSnapshot.h"
 #include <unordered_map>
 #include <vector>
+#include <utility>
 
 
 //Calculates the Closeness Centrality score for every user.
 //network The populated SocialNetwork object.
+//threads Worker threads for the batched multi-source BFS (0 = one per hardware thread).
 //Returns an unordered_map<int, double> mapping UserID to its Closeness Score.
  
-unordered_map<int, double> calculate_closeness_scores(const SocialNetwork& network);
\ No newline at end of file
+unordered_map<int, double> calculate_closeness_scores(const SocialNetwork& network, int threads = 0);
+
+
+//Same as above, but runs directly on a frozen CSR snapshot of the network.
+ 
+unordered_map<int, double> calculate_closeness_scores(const GraphSnapshot& graph, int threads = 0);
+
+//Work report for one top-k closeness query.
+struct ClosenessTopKStats {
+    int sourcesExplored = 0; // BFS runs that finished (score computed exactly)
+    int sourcesPruned = 0;   // BFS runs abandoned once they could no longer reach the top k
+    long long verticesVisited = 0; // total vertices dequeued across all BFS runs
+};
+
+
+//Finds the k users with the highest Closeness Centrality without scoring everyone.
+//Each user's BFS is abandoned as soon as an upper bound on its score (from the
+//distances found so far and its component size) falls below the current k-th
+//best score (Bergamini et al.). Scores are the same as calculate_closeness_scores.
+//network The populated SocialNetwork object.
+//k How many users to return.
+//degreeOrder Try high-degree users first, which usually finds good scores early
+//and makes the pruning bite sooner.
+//stats If non-null, receives how many BFS runs were pruned.
+//Returns up to k (UserID, score) pairs, highest score first (ties by lower UserID).
+ 
+vector<pair<int, double>> top_k_closeness(const SocialNetwork& network, int k, bool degreeOrder = true,
+                                          ClosenessTopKStats* stats = nullptr);
+
+
+//Same as above, but runs directly on a frozen CSR snapshot of the network.
+ 
+vector<pair<int, double>> top_k_closeness(const GraphSnapshot& graph, int k, bool degreeOrder = true,
+                                          ClosenessTopKStats* stats = nullptr);
\ No newline at end of file
@@ -1,82 +1,274 @@
 #include "communities.h"
 #include "../LogManager.h"
+#include "../Parallel.h"
 #include <unordered_map>
 #include <vector>
-#include <map>
-#include <cstdlib>
-#include <ctime>
+#include <atomic>
+#include <random>
+#include <algorithm>
 
 using namespace std;
 
-unordered_map<int, int> detect_communities(const SocialNetwork& network, int iterations) {
+// Users are handed out to threads in chunks of this size. Each chunk seeds its
+// own generator from (seed, round, chunk), so the thread count never changes the result.
+static const int USER_CHUNK = 4096;
+
+unordered_map<int, int> detect_communities(const SocialNetwork& network, int iterations, int threads,
+                                           double minChangeFraction, uint64_t seed, CommunityStats* stats) {
+    return detect_communities(*network.snapshot(), iterations, threads, minChangeFraction, seed, stats);
+}
+
+unordered_map<int, int> detect_communities(const GraphSnapshot& graph, int iterations, int threads,
+                                           double minChangeFraction, uint64_t seed, CommunityStats* stats) {
     
-    // Initialize random seed for tie-breaking
-    static bool seeded = false;
-    if (!seeded) {
-        srand(time(nullptr));
-        seeded = true;
+    // Seed for random tie-breaking
+    if (seed == 0) {
+        seed = random_device{}();
     }
     
-    const auto& allUsers = network.get_all_users();
-    unordered_map<int, int> labels;
+    int N = graph.num_users();
+    CommunityStats report;
 
     // --- 1. Initialization ---
-    // Every user starts with their own unique label (their ID)
-    for (int userID : allUsers) {
-        labels[userID] = userID;
+    // Every user starts with their own unique label
+    // (labels are dense indices while running and become user IDs at the end)
+    vector<int> labels(N);
+    for (int v = 0; v < N; ++v) {
+        labels[v] = v;
     }
 
+    int numChunks = (N + USER_CHUNK - 1) / USER_CHUNK;
+    int T = max(1, min(resolve_thread_count(threads), numChunks));
+
+    // Per-thread scratch, reused for every user: the neighbors' labels (sorted,
+    // so equal labels form runs) and the labels tied for the most votes.
+    // Both stay within the largest degree, whatever the size of the graph.
+    vector<vector<int>> neighborLabels(T), candidates(T);
+    vector<int> changedByThread(T);
+
     // --- 2. Iteration ---
-    for (int i = 0; i < iterations; ++i) {
-        // We must update all at once, so we use a 'new_labels' map
-        unordered_map<int, int> new_labels = labels;
-        
-        for (int userID : allUsers) {
-            // --- Tally the votes from neighbors ---
-            map<int, int> neighbor_votes; // map<LabelID, VoteCount>
-            
-            const auto& neighbors = network.get_friends(userID);
-            if (neighbors.empty()) {
-                continue; // This user has no friends, they keep their label
+    // We must update all at once, so every round writes a separate 'new_labels' array
+    vector<int> new_labels(N);
+    for (int round = 0; round < iterations; ++round) {
+        atomic<int> next_chunk(0);
+        fill(changedByThread.begin(), changedByThread.end(), 0);
+
+        run_in_parallel(T, [&](int t) {
+            vector<int>& votes = neighborLabels[t];
+            vector<int>& tied = candidates[t];
+
+            while (true) {
+                int chunk = next_chunk.fetch_add(1);
+                if (chunk >= numChunks) break;
+                seed_seq seq{seed, static_cast<uint64_t>(round), static_cast<uint64_t>(chunk)};
+                mt19937 rng(seq);
+
+                int first = chunk * USER_CHUNK;
+                int last = min(N, first + USER_CHUNK);
+                for (int v = first; v < last; ++v) {
+                    const auto neighbors = graph.neighbors_of(v);
+                    if (neighbors.empty()) {
+                        new_labels[v] = labels[v]; // This user has no friends, they keep their label
+                        continue;
+                    }
+
+                    // --- Tally the votes from neighbors (sorted, so equal labels are runs) ---
+                    votes.clear();
+                    for (int w : neighbors) votes.push_back(labels[w]);
+                    sort(votes.begin(), votes.end());
+
+                    // --- Find the winning label (with random tie-breaking) ---
+                    // Collect all labels with max votes (in label order, so the
+                    // pick does not depend on neighbor order)
+                    int max_votes = 0;
+                    tied.clear();
+                    for (size_t i = 0; i < votes.size();) {
+                        size_t j = i;
+                        while (j < votes.size() && votes[j] == votes[i]) ++j;
+                        int count = static_cast<int>(j - i);
+                        if (count > max_votes) {
+                            max_votes = count;
+                            tied.clear();
+                        }
+                        if (count == max_votes) tied.push_back(votes[i]);
+                        i = j;
+                    }
+
+                    // Randomly select one if there's a tie
+                    int winning_label = tied.size() == 1
+                        ? tied[0]
+                        : tied[uniform_int_distribution<int>(0, tied.size() - 1)(rng)];
+                    new_labels[v] = winning_label;
+                    if (winning_label != labels[v]) changedByThread[t]++;
+                }
             }
+        });
+
+        // Log the recolor event for every user who changed community
+        // (in user order, after the round, since the log is not thread-safe)
+        int changed = 0;
+        for (int t = 0; t < T; ++t) changed += changedByThread[t];
+        if (changed > 0) {
+            for (int v = 0; v < N; ++v) {
+                if (new_labels[v] != labels[v]) {
+                    LogManager::log("recolor", graph.user_id(v), -1, graph.user_id(new_labels[v]));
+                }
+            }
+        }
+
+        // All votes are in, update the main labels array
+        labels.swap(new_labels);
+        report.rounds++;
+        report.changesPerRound.push_back(changed);
+
+        // Stop early once (almost) nobody changes any more
+        if (changed == 0 || changed < minChangeFraction * N) {
+            report.converged = true;
+            break;
+        }
+    }
+
+    // --- 3. Return the final community map ---
+    unordered_map<int, int> result;
+    result.reserve(N);
+    for (int v = 0; v < N; ++v) {
+        result[graph.user_id(v)] = graph.user_id(labels[v]);
+    }
+    if (stats) *stats = report;
+    return result;
+}
+
+unordered_map<int, int> update_communities(const GraphSnapshot& graph, const unordered_map<int, int>& previousLabels,
+                                           const vector<GraphChange>& changes, int maxRounds,
+                                           CommunityUpdateStats* stats) {
+    int N = graph.num_users();
+    CommunityUpdateStats report;
 
-            for (int friendID : neighbors) {
-                neighbor_votes[labels[friendID]]++;
+    // --- 1. Carry the previous labels over (new users start alone) ---
+    vector<int> labels(N);
+    for (int v = 0; v < N; ++v) {
+        auto it = previousLabels.find(graph.user_id(v));
+        labels[v] = it == previousLabels.end() ? graph.user_id(v) : it->second;
+    }
+
+    // --- 2. Start from the users the changes touched ---
+    // 'queued' stamps each user with the last round it was queued for
+    vector<int> queued(N, -1);
+    vector<int> frontier, nextFrontier;
+    for (const GraphChange& change : changes) {
+        for (int userID : {change.userA, change.userB}) {
+            int v = userID == -1 ? -1 : graph.index_of(userID);
+            if (v != -1 && queued[v] != 0) {
+                queued[v] = 0;
+                frontier.push_back(v);
             }
+        }
+    }
+
+    // --- 3. Propagate only where labels move ---
+    vector<int> neighborLabels;
+    for (int round = 0; round < maxRounds && !frontier.empty(); ++round) {
+        report.rounds++;
+        sort(frontier.begin(), frontier.end()); // user order, so the result is repeatable
+
+        for (int v : frontier) {
+            report.evaluated++;
+            const auto neighbors = graph.neighbors_of(v);
+            if (neighbors.empty()) continue; // This user has no friends, they keep their label
 
-            // --- Find the winning label (with random tie-breaking) ---
-            int max_votes = 0;
-            vector<int> candidates; // All labels with max votes
-            
-            // Find the maximum vote count
-            for (auto const& [label, count] : neighbor_votes) {
+            // --- Tally the votes from neighbors (sorted, so equal labels are runs) ---
+            neighborLabels.clear();
+            for (int w : neighbors) neighborLabels.push_back(labels[w]);
+            sort(neighborLabels.begin(), neighborLabels.end());
+
+            int winning_label = labels[v];
+            int max_votes = 0, own_votes = 0;
+            for (size_t i = 0; i < neighborLabels.size();) {
+                size_t j = i;
+                while (j < neighborLabels.size() && neighborLabels[j] == neighborLabels[i]) ++j;
+                int count = static_cast<int>(j - i);
+                if (neighborLabels[i] == labels[v]) own_votes = count;
                 if (count > max_votes) {
                     max_votes = count;
+                    winning_label = neighborLabels[i]; // lowest label among equal counts
                 }
+                i = j;
             }
-            
-            // Collect all labels with max votes
-            for (auto const& [label, count] : neighbor_votes) {
-                if (count == max_votes) {
-                    candidates.push_back(label);
+            if (own_votes == max_votes) continue; // ties keep the current label
+
+            // The label moved: friends must recount their votes next round
+            labels[v] = winning_label;
+            report.relabelled++;
+            LogManager::log("recolor", graph.user_id(v), -1, winning_label);
+            for (int w : neighbors) {
+                if (queued[w] != round + 1) {
+                    queued[w] = round + 1;
+                    nextFrontier.push_back(w);
                 }
             }
-            
-            // Randomly select one if there's a tie
-            int winning_label = candidates[rand() % candidates.size()];
-            
-            // Update the user's label for the *next* iteration
-            // Log the recolor event when a user changes community
-            if (winning_label != labels[userID]) {
-                LogManager::log("recolor", userID, -1, winning_label);
-            }
-            new_labels[userID] = winning_label;
         }
-        
-        // All votes are in, update the main labels map
-        labels = new_labels;
+
+        frontier.swap(nextFrontier);
+        nextFrontier.clear();
     }
+    report.converged = frontier.empty();
 
-    // --- 3. Return the final community map ---
-    return labels;
+    // --- 4. Return the full community map ---
+    unordered_map<int, int> result;
+    result.reserve(N);
+    for (int v = 0; v < N; ++v) {
+        result[graph.user_id(v)] = labels[v];
+    }
+    if (stats) *stats = report;
+    return result;
+}
+
+shared_ptr<const CommunityResult> CommunityCache::get(const SocialNetwork& network, bool* cached) {
+    lock_guard<mutex> guard(lock);
+    if (current && current->version == network.get_version()) {
+        if (cached) *cached = true;
+        LogManager::events.insert(LogManager::events.end(), current->recolor.begin(), current->recolor.end());
+        return current;
+    }
+    if (cached) *cached = false;
+
+    auto result = make_shared<CommunityResult>();
+    result->version = network.get_version();
+    shared_ptr<const GraphSnapshot> graph = network.snapshot();
+
+    vector<GraphChange> changes;
+    if (current && network.changes_since(current->version, changes)) {
+        result->incremental = true;
+        result->changesApplied = changes.size();
+        // The update only logs the users it relabels; the full assignment is replayed below instead
+        size_t logStart = LogManager::events.size();
+        result->labels = update_communities(*graph, current->labels, changes, 10, &result->update);
+        LogManager::events.erase(LogManager::events.begin() + logStart, LogManager::events.end());
+    } else {
+        result->labels = detect_communities(*graph, 10, 0, 0.001, 0, &result->full);
+    }
+
+    // Final label of every user, replayed whenever this result is served again
+    int N = graph->num_users();
+    result->recolor.reserve(N);
+    for (int v = 0; v < N; ++v) {
+        int userID = graph->user_id(v);
+        result->recolor.push_back({"recolor", userID, -1, static_cast<double>(result->labels.at(userID))});
+    }
+    if (result->incremental) {
+        LogManager::events.insert(LogManager::events.end(), result->recolor.begin(), result->recolor.end());
+    }
+
+    current = result;
+    return current;
+}
+
+void CommunityCache::clear() {
+    lock_guard<mutex> guard(lock);
+    current.reset();
+}
+
+CommunityCache& CommunityCache::shared() {
+    static CommunityCache instance;
+    return instance;
 }
\ No newline at end of file
@@ -2,13 +2,120 @@
 
 using namespace std;
 #include "../SocialNetwork.h"
+#include "../GraphSnapshot.h"
+#include "../LogManager.h"
 #include <unordered_map>
 #include <vector>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+
+//Convergence report for one Label Propagation run.
+struct CommunityStats {
+    int rounds = 0;              // rounds actually run
+    vector<int> changesPerRound; // users whose label changed in each round
+    bool converged = false;      // true if it stopped because few enough labels changed
+};
 
 
 //Detects communities in the graph using the Label Propagation Algorithm.
 //network The populated SocialNetwork object.
-//iterations The number of iterations to run (e.g., 10).
+//iterations The maximum number of rounds to run (e.g., 10).
+//threads Worker threads per round (0 = one per hardware thread).
+//minChangeFraction Stop once a round changes fewer than this fraction of the labels.
+//seed Seed for random tie-breaking (0 = a fresh random seed per call). With a
+//fixed seed the result is the same for any thread count.
+//stats If non-null, receives the rounds run and the labels changed per round.
 //Returns an unordered_map<int, int> mapping UserID to its final CommunityID.
  
-unordered_map<int, int> detect_communities(const SocialNetwork& network, int iterations = 10);
\ No newline at end of file
+unordered_map<int, int> detect_communities(
+    const SocialNetwork& network,
+    int iterations = 10,
+    int threads = 0,
+    double minChangeFraction = 0.001,
+    uint64_t seed = 0,
+    CommunityStats* stats = nullptr
+);
+
+
+//Same as above, but runs directly on a frozen CSR snapshot of the network.
+ 
+unordered_map<int, int> detect_communities(
+    const GraphSnapshot& graph,
+    int iterations = 10,
+    int threads = 0,
+    double minChangeFraction = 0.001,
+    uint64_t seed = 0,
+    CommunityStats* stats = nullptr
+);
+
+
+//Report for one incremental community update.
+struct CommunityUpdateStats {
+    int rounds = 0;             // propagation rounds run
+    long long evaluated = 0;    // users whose votes were re-counted (summed over rounds)
+    long long relabelled = 0;   // label changes made
+    bool converged = false;     // true if no label was still changing at the end
+};
+
+
+//Brings an earlier community assignment up to date after some friendships or
+//users were added or removed, without another whole-graph pass.
+//Only the users touched by the changes are re-evaluated at first; whenever a
+//user's label changes, its friends are re-evaluated in the next round, so the
+//update spreads only as far as labels actually move.
+//A re-evaluated user adopts the most common label among its friends, keeping
+//its own label on a tie (or the lowest tied label, if its own is not among them).
+//graph The graph after the changes.
+//previousLabels The earlier UserID -> CommunityID map (users missing from it start alone).
+//changes The changes since that map was computed (see SocialNetwork::changes_since).
+//maxRounds Upper bound on propagation rounds.
+//stats If non-null, receives how many users were re-evaluated and relabelled.
+//Returns the updated UserID -> CommunityID map.
+ 
+unordered_map<int, int> update_communities(
+    const GraphSnapshot& graph,
+    const unordered_map<int, int>& previousLabels,
+    const vector<GraphChange>& changes,
+    int maxRounds = 10,
+    CommunityUpdateStats* stats = nullptr
+);
+
+
+//One cached community assignment.
+struct CommunityResult {
+    unordered_map<int, int> labels;  // UserID -> CommunityID
+    uint64_t version = 0;            // SocialNetwork::get_version() it belongs to
+    bool incremental = false;        // true if produced by update_communities
+    size_t changesApplied = 0;       // changes folded in by that update
+    CommunityStats full;             // rounds of the full run (if not incremental)
+    CommunityUpdateStats update;     // work done by the update (if incremental)
+    vector<LogEvent> recolor;        // one "recolor" event per user (UserID order) for the final labels
+};
+
+
+//Keeps the Label Propagation communities in step with the network.
+//Keyed by SocialNetwork::get_version(): unchanged graphs reuse the last result;
+//after edits the result is patched with update_communities when the network's
+//change history allows it, and recomputed with detect_communities otherwise.
+//Thread-safe; results are immutable and stay valid after later mutations.
+class CommunityCache {
+public:
+    //Gets the communities for the network's current version.
+    //Appends to the dashboard log: a full run logs its rounds as it goes, while
+    //a cached result or an incremental update replays the final label of every
+    //user (so the export always shows the whole assignment).
+    //cached If non-null, set to true when the last result was reused unchanged.
+    shared_ptr<const CommunityResult> get(const SocialNetwork& network, bool* cached = nullptr);
+
+    //Drops the cached result, so the next get() runs detect_communities again.
+    void clear();
+
+    //The process-wide instance used by the menu.
+    static CommunityCache& shared();
+
+private:
+    mutable mutex lock;
+    shared_ptr<const CommunityResult> current;
+};
\ No newline at end of file
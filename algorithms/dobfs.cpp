@@ -0,0 +1,145 @@
+#include "dobfs.h"
+#include "../Parallel.h"
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+using namespace std;
+
+// Below this many arcs every level runs on the calling thread
+static const uint64_t PARALLEL_MIN_ARCS = 1 << 16;
+
+namespace {
+
+inline bool test_bit(const vector<uint64_t>& bits, int v) {
+    return (bits[v >> 6] >> (v & 63)) & 1;
+}
+
+inline void set_bit(vector<uint64_t>& bits, int v) {
+    bits[v >> 6] |= uint64_t(1) << (v & 63);
+}
+
+// Reads v's bit while other threads may be claiming bits in the same word.
+inline bool test_bit_shared(const vector<uint64_t>& bits, int v) {
+    return (__atomic_load_n(&bits[v >> 6], __ATOMIC_RELAXED) >> (v & 63)) & 1;
+}
+
+// Sets v's bit atomically; returns true if this call was the one that set it.
+inline bool claim_bit(vector<uint64_t>& bits, int v) {
+    uint64_t bit = uint64_t(1) << (v & 63);
+    return !(__atomic_fetch_or(&bits[v >> 6], bit, __ATOMIC_RELAXED) & bit);
+}
+
+}
+
+BFSResult direction_optimizing_bfs(const GraphSnapshot& graph, int source, int threads, double alpha, double beta) {
+    int N = graph.num_users();
+    BFSResult result;
+    result.distance.assign(N, -1);
+    result.parent.assign(N, -1);
+    if (source < 0 || source >= N) return result;
+
+    const uint64_t* offsets = graph.offsets();
+    int T = offsets[N] < PARALLEL_MIN_ARCS ? 1 : max(1, resolve_thread_count(threads));
+    int words = (N + 63) / 64;
+
+    vector<uint64_t> visited(words, 0);
+    vector<uint64_t> frontierBits(words, 0), nextBits(words, 0);
+    vector<int> frontier = {source};
+    vector<vector<int>> localNext(T);
+
+    result.distance[source] = 0;
+    set_bit(visited, source);
+
+    // Edge counts for the direction heuristic
+    long long unexploredEdges = (long long)offsets[N] - graph.degree(source);
+    long long frontierEdges = graph.degree(source);
+    long long frontierSize = 1;
+    bool bottomUp = false;
+
+    for (int level = 1; frontierSize > 0; ++level) {
+        // --- Pick the direction for this level ---
+        if (!bottomUp && frontierEdges > unexploredEdges / alpha) {
+            // Switch to bottom-up: the frontier becomes a bitmap
+            bottomUp = true;
+            fill(frontierBits.begin(), frontierBits.end(), 0);
+            for (int v : frontier) set_bit(frontierBits, v);
+        } else if (bottomUp && frontierSize < N / beta) {
+            // Back to top-down: the frontier becomes a list again
+            bottomUp = false;
+            frontier.clear();
+            for (int w = 0; w < words; ++w) {
+                for (uint64_t bits = frontierBits[w]; bits; bits &= bits - 1) {
+                    frontier.push_back(w * 64 + __builtin_ctzll(bits));
+                }
+            }
+        }
+
+        vector<long long> levelEdges(T, 0), levelSize(T, 0);
+
+        if (!bottomUp) {
+            // --- Top-down step: frontier vertices claim their unvisited neighbors ---
+            result.topDownSteps++;
+            int stepThreads = frontier.size() < 64 ? 1 : T;
+            run_in_parallel(stepThreads, [&](int t) {
+                vector<int>& found = localNext[t];
+                found.clear();
+                size_t first = frontier.size() * t / stepThreads;
+                size_t last = frontier.size() * (t + 1) / stepThreads;
+                for (size_t i = first; i < last; ++i) {
+                    int v = frontier[i];
+                    for (int w : graph.neighbors_of(v)) {
+                        if (test_bit_shared(visited, w) || !claim_bit(visited, w)) continue;
+                        result.distance[w] = level;
+                        result.parent[w] = v;
+                        found.push_back(w);
+                        levelEdges[t] += graph.degree(w);
+                    }
+                }
+                levelSize[t] = found.size();
+            });
+
+            frontier.clear();
+            for (int t = 0; t < stepThreads; ++t) {
+                frontier.insert(frontier.end(), localNext[t].begin(), localNext[t].end());
+            }
+        } else {
+            // --- Bottom-up step: unvisited vertices look for a parent in the frontier ---
+            // Threads own whole 64-vertex words, so bitmap writes never collide.
+            result.bottomUpSteps++;
+            run_in_parallel(T, [&](int t) {
+                int firstWord = (long long)words * t / T;
+                int lastWord = (long long)words * (t + 1) / T;
+                for (int w = firstWord; w < lastWord; ++w) {
+                    nextBits[w] = 0;
+                    uint64_t unvisited = ~visited[w];
+                    for (; unvisited; unvisited &= unvisited - 1) {
+                        int v = w * 64 + __builtin_ctzll(unvisited);
+                        if (v >= N) break;
+                        for (int u : graph.neighbors_of(v)) {
+                            if (!test_bit(frontierBits, u)) continue;
+                            result.distance[v] = level;
+                            result.parent[v] = u;
+                            nextBits[w] |= uint64_t(1) << (v & 63);
+                            levelEdges[t] += graph.degree(v);
+                            levelSize[t]++;
+                            break;
+                        }
+                    }
+                    visited[w] |= nextBits[w];
+                }
+            });
+            frontierBits.swap(nextBits);
+        }
+
+        frontierEdges = 0;
+        frontierSize = 0;
+        for (int t = 0; t < T; ++t) {
+            frontierEdges += levelEdges[t];
+            frontierSize += levelSize[t];
+        }
+        unexploredEdges -= frontierEdges;
+    }
+
+    return result;
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+using namespace std;
+#include "../GraphSnapshot.h"
+#include <vector>
+
+
+//Distances and BFS tree from one direction-optimizing BFS run.
+//All vertices are dense snapshot indices.
+struct BFSResult {
+    vector<int> distance;  // hops from the source, -1 if unreachable
+    vector<int> parent;    // previous vertex on a shortest path, -1 for the source / unreachable
+    int topDownSteps = 0;  // levels expanded from the frontier outwards
+    int bottomUpSteps = 0; // levels expanded by unvisited vertices looking for a frontier parent
+};
+
+
+//Breadth-first search that picks a direction per level (Beamer et al.).
+//Small frontiers expand top-down (scan the frontier's edges); once the frontier's
+//edges outnumber the unexplored edges / alpha it switches to bottom-up (every
+//unvisited vertex checks whether any neighbor is in the frontier, stopping at
+//the first hit), and back to top-down when the frontier shrinks below N / beta.
+//Visited and bottom-up frontier sets are bitmaps.
+//graph The CSR snapshot.
+//source Dense index of the start vertex.
+//threads Worker threads per level (0 = auto; small graphs always run on one thread).
+//Distances are deterministic; with more than one thread, the parent chosen
+//among equally short options may differ between runs.
+ 
+BFSResult direction_optimizing_bfs(
+    const GraphSnapshot& graph,
+    int source,
+    int threads = 1,
+    double alpha = 15.0,
+    double beta = 18.0
+);
\ No newline at end of file
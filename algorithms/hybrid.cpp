@@ -3,17 +3,95 @@
 #include "proximity.h"
 #include "utils.h"
 #include "pagerank.h"
+#include "workspace.h"
 #include "../LogManager.h"
-#include <unordered_map>
-#include <queue>
-#include <utility>
 #include <cmath>
+#include <algorithm>
+#include <functional>
 
 using namespace std;
-using ScorePair = pair<double, int>;
+
+namespace {
+
+// Relative slack on the Threshold Algorithm's stopping bound, so that
+// floating-point rounding in the fused sums can never stop it too early
+const double BOUND_SLACK = 1e-9;
+
+// Fagin's Threshold Algorithm over two sorted streams (weights must be > 0):
+//  - proximity: friends-of-friends by weighted Adamic-Adar, highest first
+//  - influence: all users by PageRank, highest first; since Jaccard <= 1,
+//    w_influence * PageRank bounds the influence term of everyone not yet seen
+//Each user met on either stream gets their exact fused score (summed in the
+//same order as the full computation, so the result is bit-for-bit the same).
+//The walk stops once the k-th best score beats the best any unseen user could reach.
+//Leaves the top k in the workspace's selection and returns true, or returns
+//false after 'budget' influence steps (then the full computation is cheaper).
+bool select_threshold(const SocialNetwork& network, const PageRankResult& pagerank, int userID,
+                      double w_influence, double w_proximity, int top_k, size_t budget, QueryWorkspace& ws) {
+    const GraphSnapshot& graph = *pagerank.graph;
+    const vector<int>& myTagIDs = network.get_tag_ids(userID);
+
+    // --- 1. Proximity stream (the full computation's per-candidate sums, minus the influence term) ---
+    score_proximity(graph, w_proximity, ws);
+    vector<pair<double, int>>& proximity = ws.pairs();
+    for (int c : ws.touched()) proximity.push_back({ws.score(c), c});
+    sort(proximity.begin(), proximity.end(), greater<pair<double, int>>());
+
+    // --- 2. Exact fused score of one user, the first time either stream meets them ---
+    auto evaluate = [&](int c) {
+        if (ws.is_excluded(c)) return;
+        ws.increment(c); // counts double as the "already seen" marks
+        if (ws.count(c) > 1) return;
+
+        double influenceScore = pagerank.dense[c] * jaccard_similarity(myTagIDs, network.get_tag_ids(graph.user_id(c)));
+        double fused;
+        if (influenceScore > 0) {
+            fused = w_influence * influenceScore;
+            if (ws.is_scored(c)) {
+                // Replay the Adamic-Adar terms after the influence term, in friend order
+                for (int f : ws.order()) {
+                    int commonFriendDegree = graph.degree(f);
+                    if (commonFriendDegree <= 1) continue;
+                    auto row = graph.neighbors_of(f);
+                    if (binary_search(row.begin(), row.end(), c)) {
+                        fused += w_proximity * (1.0 / log(commonFriendDegree));
+                    }
+                }
+            }
+        } else if (ws.is_scored(c)) {
+            fused = ws.score(c);
+        } else {
+            return; // neither stream would score them: not a candidate
+        }
+        ws.offer(fused, c);
+    };
+
+    // --- 3. Alternate between the streams until the threshold is beaten ---
+    const vector<int>& ranked = pagerank.ranked();
+    size_t i = 0, j = 0;
+    ws.start_selection(top_k);
+    while (i < ranked.size()) {
+        evaluate(ranked[i++]);
+        if (j < proximity.size()) evaluate(proximity[j++].second);
+        if (i == ranked.size()) break; // everyone has been seen
+
+        double bound = w_influence * pagerank.dense[ranked[i]] + (j < proximity.size() ? proximity[j].first : 0.0);
+        if (ws.selection_full() && ws.kth().first > bound * (1.0 + BOUND_SLACK)) break;
+        if (i > budget) return false;
+    }
+    return true;
+}
+
+}
 
 vector<int> recommend_by_hybrid(const SocialNetwork& network, int userID, int top_k, double w_influence, double w_proximity) {
-    
+    vector<int> recommendations;
+    recommend_by_hybrid(network, userID, top_k, w_influence, w_proximity, recommendations);
+    return recommendations;
+}
+
+void recommend_by_hybrid(const SocialNetwork& network, int userID, int top_k, double w_influence, double w_proximity,
+                         vector<int>& out) {
     // Clear logs and set algorithm info
     LogManager::clear();
     LogManager::setAlgorithm(
@@ -22,58 +100,70 @@ vector<int> recommend_by_hybrid(const SocialNetwork& network, int userID, int to
         userID
     );
     LogManager::log("source", userID);
-    
-    unordered_map<int, double> hybridScores;
+    out.clear();
 
-    // --- Pre-calculate PageRank (without logging) ---
-    unordered_map<int, double> pagerank_scores = calculate_pagerank(network, 0.85, 100, false);
+    // --- Get PageRank scores (computed once per graph version, then cached) ---
+    auto pagerank = PageRankCache::shared().get(network);
+    const GraphSnapshot& graph = *pagerank->graph; // PageRank's dense indices are this snapshot's
+    if (top_k <= 0) return;
 
-    // --- Influence Score Logic ---
-    const auto& myFriends = network.get_friends(userID);
-    const auto& myTags = network.get_tags(userID);
-    
-    for (int candidateID : network.get_all_users()) {
-        if (candidateID == userID || myFriends.count(candidateID)) continue;
+    // Dense scores in this thread's reusable workspace (no per-query tables)
+    QueryWorkspace& ws = QueryWorkspace::local();
+    if (start_recommendation_query(network, graph, userID, ws) == -1) return;
 
-        const auto& candidateTags = network.get_tags(candidateID);
-        double jaccard = jaccard_similarity(myTags, candidateTags);
-        
-        double pagerank = pagerank_scores[candidateID];
-        double influenceScore = pagerank * jaccard;
+    bool usedThreshold = false;
+    const vector<pair<double, int>>& best =
+        score_hybrid(network, *pagerank, userID, top_k, w_influence, w_proximity, ws, &usedThreshold);
 
-        if (influenceScore > 0) {
-            hybridScores[candidateID] += w_influence * influenceScore;
-            LogManager::log("scan", candidateID, userID, influenceScore);
+    // --- Replay the influence terms for the dashboard, in the order they were computed ---
+    // (the users either stream met, or everyone sharing a tag; a tagless user is
+    // compared with everyone by the full computation)
+    const vector<int>& myTagIDs = network.get_tag_ids(userID);
+    auto logInfluence = [&](int c) {
+        int candidateID = graph.user_id(c);
+        double influenceScore = pagerank->dense[c] * jaccard_similarity(myTagIDs, network.get_tag_ids(candidateID));
+        if (influenceScore > 0) LogManager::log("scan", candidateID, userID, influenceScore);
+    };
+    if (usedThreshold || !myTagIDs.empty()) {
+        for (int c : ws.counted()) logInfluence(c);
+    } else {
+        for (int c = 0; c < graph.num_users(); ++c) {
+            if (!ws.is_excluded(c)) logInfluence(c);
         }
     }
+    for (int f : ws.order()) LogManager::log("visit", graph.user_id(f), userID);
 
-    // --- Proximity Score Logic ---
-    for (int friendID : myFriends) {
-        LogManager::log("visit", friendID, userID);
-        for (int fofID : network.get_friends(friendID)) {
-            if (fofID == userID || myFriends.count(fofID)) continue;
-            
-            int commonFriendDegree = network.get_degree(friendID);
-            if (commonFriendDegree > 1) {
-                hybridScores[fofID] += w_proximity * (1.0 / log(commonFriendDegree));
-            }
-        }
+    for (const auto& [score, index] : best) {
+        int recID = graph.user_id(index);
+        out.push_back(recID);
+        LogManager::log("match", recID, userID, score);
     }
+}
 
-    // --- Get Top K Results ---
-    priority_queue<ScorePair> pq;
-    for (auto const& [candidateID, score] : hybridScores) {
-        pq.push({score, candidateID});
-    }
+const vector<pair<double, int>>& score_hybrid(const SocialNetwork& network, const PageRankResult& pagerank, int userID,
+                                              int top_k, double w_influence, double w_proximity, QueryWorkspace& ws,
+                                              bool* usedThreshold, const DenseTagIndex* tags) {
+    const GraphSnapshot& graph = *pagerank.graph;
+    if (usedThreshold) *usedThreshold = false;
 
-    // --- Format Output ---
-    vector<int> recommendations;
-    while (!pq.empty() && recommendations.size() < static_cast<size_t>(top_k)) {
-        int recID = pq.top().second;
-        double score = pq.top().first;
-        recommendations.push_back(recID);
-        LogManager::log("match", recID, userID, score);
-        pq.pop();
+    // --- Threshold Algorithm (positive weights only: the bound needs both terms to grow with their stream) ---
+    if (w_influence > 0 && w_proximity > 0 && top_k > 0) {
+        // Give up once it has walked as far as the full computation's influence scan would
+        size_t budget = 0;
+        const vector<int>& myTagIDs = network.get_tag_ids(userID);
+        if (myTagIDs.empty()) budget = graph.num_users();
+        for (int tagID : myTagIDs) budget += network.get_tag_users(tagID).size();
+
+        if (select_threshold(network, pagerank, userID, w_influence, w_proximity, top_k, budget, ws)) {
+            if (usedThreshold) *usedThreshold = true;
+            return ws.selection();
+        }
+        start_recommendation_query(network, graph, userID, ws);
     }
-    return recommendations;
+
+    // --- Full computation (any weights): the influence term of every user
+    // sharing a tag, then the Adamic-Adar terms, summed per candidate ---
+    score_influence(network, pagerank, userID, w_influence, ws, tags);
+    score_proximity(graph, w_proximity, ws);
+    return ws.top_k(top_k);
 }
\ No newline at end of file
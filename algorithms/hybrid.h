@@ -2,6 +2,11 @@
 
 #include "../SocialNetwork.h"
 #include <vector>
+#include <utility>
+
+class QueryWorkspace;
+struct PageRankResult;
+struct DenseTagIndex;
 
 
 //Recommends users using a hybrid rank-based approach.
@@ -11,5 +16,28 @@
 //w_influence The weight given to the influence rank.
 //w_proximity The weight given to the proximity rank.
 //Returns a vector of recommended user IDs, sorted by hybrid score.
+//With both weights positive, the top k are found with Fagin's Threshold
+//Algorithm over the proximity and PageRank-ordered influence streams, which
+//usually stops after a handful of users; other weights (or a walk that gets
+//too long) use the full computation. Both give exactly the same result.
+ 
+vector<int> recommend_by_hybrid(const SocialNetwork& network, int userID, int top_k, double w_influence, double w_proximity);
+
+
+//Same as above, but writes into 'out' (cleared first) so a caller that reuses
+//it makes no allocations once its capacity has grown (see QueryWorkspace).
+ 
+void recommend_by_hybrid(const SocialNetwork& network, int userID, int top_k, double w_influence, double w_proximity,
+                         vector<int>& out);
+
+
+//Logging-free core of recommend_by_hybrid, shared with the batch recommender:
+//scores the query ws holds (see start_recommendation_query) and returns the
+//top k as (score, index in pagerank.graph), best first. The result lives in ws.
+//usedThreshold If given, set to whether the Threshold Algorithm found the top k
+//(its candidates are then in ws.counted()) rather than the full computation.
+//tags Optional DenseTagIndex for the full computation (see score_influence).
  
-vector<int> recommend_by_hybrid(const SocialNetwork& network, int userID, int top_k, double w_influence, double w_proximity);
\ No newline at end of file
+const vector<pair<double, int>>& score_hybrid(const SocialNetwork& network, const PageRankResult& pagerank, int userID,
+                                              int top_k, double w_influence, double w_proximity, QueryWorkspace& ws,
+                                              bool* usedThreshold = nullptr, const DenseTagIndex* tags = nullptr);
\ No newline at end of file
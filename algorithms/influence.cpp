@@ -1,6 +1,8 @@
 #include "influence.h"
 #include "utils.h"
 #include "pagerank.h"
+#include "minhash.h"
+#include "workspace.h"
 #include "../LogManager.h"
 #include <queue>
 #include <vector>
@@ -11,6 +13,12 @@ using namespace std;
 using ScorePair = pair<double, int>;
 
 vector<int> recommend_by_influence(const SocialNetwork& network, int userID, int top_k) {
+    vector<int> recommendations;
+    recommend_by_influence(network, userID, top_k, recommendations);
+    return recommendations;
+}
+
+void recommend_by_influence(const SocialNetwork& network, int userID, int top_k, vector<int>& out) {
     
     // Clear logs and set algorithm info
     LogManager::clear();
@@ -20,47 +28,155 @@ vector<int> recommend_by_influence(const SocialNetwork& network, int userID, int
         userID
     );
     LogManager::log("source", userID);
+    out.clear();
     
-    // --- Caclulate PageRank scores ONCE (without logging) ---
-    unordered_map<int, double> pagerank_scores = calculate_pagerank(network, 0.85, 100, false);
+    // --- Get PageRank scores (computed once per graph version, then cached) ---
+    auto pagerank = PageRankCache::shared().get(network);
+    const GraphSnapshot& graph = *pagerank->graph; // PageRank's dense indices are this snapshot's
 
-    priority_queue<ScorePair> pq;
-    const auto& myFriends = network.get_friends(userID);
-    const auto& myTags = network.get_tags(userID);
+    // Dense scores in this thread's reusable workspace (no per-query tables)
+    QueryWorkspace& ws = QueryWorkspace::local();
+    if (start_recommendation_query(network, graph, userID, ws) == -1) return;
 
-    for (int candidateID : network.get_all_users()) {
-        if (candidateID == userID) continue;
-        if (myFriends.count(candidateID)) continue;
+    // --- Core Algorithm ---
+    score_influence(network, *pagerank, userID, 1.0, ws);
 
-        // --- Calculate Score ---
-        const auto& candidateTags = network.get_tags(candidateID);
-        double jaccard = jaccard_similarity(myTags, candidateTags);
-        
+    // --- Replay the candidates for the dashboard, in the order they were scored ---
+    const vector<int>& myTagIDs = network.get_tag_ids(userID);
+    auto logCandidate = [&](int candidate) {
         // Log candidates being evaluated
+        int candidateID = graph.user_id(candidate);
         LogManager::log("scan", candidateID, userID);
-        
-        // Get the pre-calculated PageRank score
-        double pagerank = pagerank_scores[candidateID]; 
-        
-        // Final Score: PageRank * Jaccard
-        double finalScore = pagerank * jaccard;
 
+        // Log if there's a tag match (exactly the candidates that scored)
+        if (ws.is_scored(candidate)) {
+            LogManager::log("visit", candidateID, userID, jaccard_similarity(myTagIDs, network.get_tag_ids(candidateID)));
+        }
+    };
+    if (myTagIDs.empty()) {
+        for (int c = 0; c < graph.num_users(); ++c) {
+            if (!ws.is_excluded(c)) logCandidate(c);
+        }
+    } else {
+        for (int c : ws.counted()) logCandidate(c);
+    }
+
+    // --- Format Output (bounded heap) ---
+    for (const auto& [score, index] : ws.top_k(top_k)) {
+        int recID = graph.user_id(index);
+        out.push_back(recID);
+        LogManager::log("match", recID, userID, score);
+    }
+}
+
+void count_shared_tags(const SocialNetwork& network, int userID, unordered_map<int, int>& sharedTags) {
+    sharedTags.clear();
+    const auto& myFriends = network.get_friends(userID);
+    for (int tagID : network.get_tag_ids(userID)) {
+        for (int candidateID : network.get_tag_users(tagID)) {
+            if (candidateID == userID || myFriends.count(candidateID)) continue;
+            sharedTags[candidateID]++;
+        }
+    }
+}
+
+vector<int> recommend_by_influence_lsh(const SocialNetwork& network, int userID, int top_k, const TagLSHIndex& index) {
+    const vector<int>& myTagIDs = network.get_tag_ids(userID);
+    if (myTagIDs.empty()) {
+        return recommend_by_influence(network, userID, top_k);
+    }
+
+    LogManager::clear();
+    LogManager::setAlgorithm(
+        "Influence Recommendation (LSH)",
+        "PageRank * Jaccard over the users a MinHash/LSH index finds with similar tags.",
+        userID
+    );
+    LogManager::log("source", userID);
+
+    auto pagerank = PageRankCache::shared().get(network);
+    const GraphSnapshot& graph = *pagerank->graph; // PageRank's dense indices are this snapshot's
+
+    priority_queue<ScorePair> pq;
+    const auto& myFriends = network.get_friends(userID);
+    vector<int> candidates;
+    index.candidates(userID, candidates);
+
+    for (int candidateID : candidates) {
+        // An index built for an older network can name users PageRank has no score for
+        int candidate = graph.index_of(candidateID);
+        if (candidate == -1 || myFriends.count(candidateID)) continue;
+        LogManager::log("scan", candidateID, userID);
+
+        double jaccard = jaccard_similarity(myTagIDs, network.get_tag_ids(candidateID));
+        double finalScore = pagerank->dense[candidate] * jaccard;
         if (finalScore > 0) {
-            // Log if there's a tag match
-            if (jaccard > 0) {
-                LogManager::log("visit", candidateID, userID, jaccard);
-            }
+            LogManager::log("visit", candidateID, userID, jaccard);
             pq.push({finalScore, candidateID});
         }
     }
 
-    // --- Format Output ---
     vector<int> recommendations;
     while (!pq.empty() && recommendations.size() < static_cast<size_t>(top_k)) {
         int recID = pq.top().second;
         recommendations.push_back(recID);
         LogManager::log("match", recID, userID, pq.top().first);
-        pq.pop(); 
+        pq.pop();
     }
     return recommendations;
+}
+
+void count_shared_tags(const SocialNetwork& network, const GraphSnapshot& graph, int userID, QueryWorkspace& ws) {
+    for (int tagID : network.get_tag_ids(userID)) {
+        for (int candidateID : network.get_tag_users(tagID)) {
+            int c = graph.index_of(candidateID);
+            if (ws.is_excluded(c)) continue;
+            ws.increment(c);
+        }
+    }
+}
+
+DenseTagIndex::DenseTagIndex(const SocialNetwork& network, const GraphSnapshot& graph)
+    : tagsOf(graph.num_users()), tagUsers(network.tag_dictionary().size()) {
+    for (int c = 0; c < graph.num_users(); ++c) {
+        tagsOf[c] = &network.get_tag_ids(graph.user_id(c));
+        for (int tagID : *tagsOf[c]) tagUsers[tagID].push_back(c);
+    }
+}
+
+void score_influence(const SocialNetwork& network, const PageRankResult& pagerank, int userID, double weight,
+                     QueryWorkspace& ws, const DenseTagIndex* tags) {
+    const GraphSnapshot& graph = *pagerank.graph;
+    const vector<int>& myTagIDs = network.get_tag_ids(userID);
+    auto tagCount = [&](int candidate) {
+        return tags ? tags->tagsOf[candidate]->size() : network.get_tag_ids(graph.user_id(candidate)).size();
+    };
+
+    auto consider = [&](int candidate, double jaccard) {
+        // Final Score: PageRank * Jaccard
+        double finalScore = pagerank.dense[candidate] * jaccard;
+        if (finalScore > 0) ws.add(candidate, weight * finalScore);
+    };
+
+    if (myTagIDs.empty()) {
+        // Two empty tag sets count as identical, so every tagless user scores: scan everyone
+        for (int c = 0; c < graph.num_users(); ++c) {
+            if (ws.is_excluded(c)) continue;
+            consider(c, jaccard_from_counts(0, tagCount(c), 0));
+        }
+    } else {
+        // Anyone sharing no tag scores 0, so only the tag posting lists are touched
+        if (tags) {
+            for (int tagID : myTagIDs) {
+                for (int c : tags->tagUsers[tagID]) {
+                    if (!ws.is_excluded(c)) ws.increment(c);
+                }
+            }
+        } else {
+            count_shared_tags(network, graph, userID, ws);
+        }
+        for (int c : ws.counted()) {
+            consider(c, jaccard_from_counts(myTagIDs.size(), tagCount(c), ws.count(c)));
+        }
+    }
 }
\ No newline at end of file
@@ -1,7 +1,13 @@
 #pragma once
 
 #include "../SocialNetwork.h"
+#include "../GraphSnapshot.h"
 #include <vector>
+#include <unordered_map>
+
+class TagLSHIndex;
+class QueryWorkspace;
+struct PageRankResult;
 
 //Recommends users based on influence (Degree * Jaccard).
 //network The populated SocialNetwork object.
@@ -9,4 +15,57 @@
 //top_k The number of recommendations to return.
 //Returns a vector of recommended user IDs, sorted by score.
  
-vector<int> recommend_by_influence(const SocialNetwork& network, int userID, int top_k);
\ No newline at end of file
+vector<int> recommend_by_influence(const SocialNetwork& network, int userID, int top_k);
+
+
+//Same as above, but writes into 'out' (cleared first) so a caller that reuses
+//it makes no allocations once its capacity has grown (see QueryWorkspace).
+ 
+void recommend_by_influence(const SocialNetwork& network, int userID, int top_k, vector<int>& out);
+
+
+//Counts how many tags each user shares with userID, walking only the posting
+//lists of userID's own tags (SocialNetwork::get_tag_users) instead of every user.
+//Users sharing no tag are left out, as are userID and their friends.
+//network The populated SocialNetwork object.
+//userID The query user.
+//sharedTags Receives candidate ID -> number of shared tags (cleared first).
+ 
+void count_shared_tags(const SocialNetwork& network, int userID, unordered_map<int, int>& sharedTags);
+
+
+//Approximate recommend_by_influence for popular tags: only the users the
+//MinHash/LSH index puts in a bucket with userID are scored (exactly, by
+//PageRank * Jaccard), instead of everyone sharing a tag.
+//Users without tags fall back to the exact recommender.
+//index A TagLSHIndex built for the network's current tags (candidates it
+//names that the network no longer has are skipped).
+ 
+vector<int> recommend_by_influence_lsh(const SocialNetwork& network, int userID, int top_k, const TagLSHIndex& index);
+
+
+//Dense version of count_shared_tags for the recommenders: counts into the
+//workspace (QueryWorkspace::counted() / count()) by index in 'graph', skipping
+//candidates the workspace already excludes.
+ 
+void count_shared_tags(const SocialNetwork& network, const GraphSnapshot& graph, int userID, QueryWorkspace& ws);
+
+
+//Every user's tag IDs and every tag's posting list, by dense index in one
+//snapshot, so that a job scoring many users does no hash or index lookups.
+struct DenseTagIndex {
+    vector<const vector<int>*> tagsOf; // index -> the user's sorted tag IDs
+    vector<vector<int>> tagUsers;      // tag ID -> indices of the users with the tag
+
+    DenseTagIndex(const SocialNetwork& network, const GraphSnapshot& graph);
+};
+
+
+//Logging-free core of recommend_by_influence, shared with the hybrid and batch
+//recommenders: adds weight * PageRank * Jaccard to every candidate of the
+//query ws holds (see start_recommendation_query) that scores above 0.
+//pagerank Scores for the graph the query was started on (pagerank.graph).
+//tags Optional DenseTagIndex for that graph (same scores, fewer lookups).
+ 
+void score_influence(const SocialNetwork& network, const PageRankResult& pagerank, int userID, double weight,
+                     QueryWorkspace& ws, const DenseTagIndex* tags = nullptr);
\ No newline at end of file
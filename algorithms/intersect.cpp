@@ -0,0 +1,88 @@
+#include "intersect.h"
+#include <algorithm>
+#include <utility>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+// Past this size ratio, galloping into the longer array beats merging
+const size_t GALLOP_RATIO = 32;
+
+// Requires na <= nb.
+size_t intersect_gallop(const int* a, size_t na, const int* b, size_t nb, int* out) {
+    size_t count = 0, j = 0;
+    for (size_t i = 0; i < na && j < nb; ++i) {
+        int value = a[i];
+        // Double the step until b[j + bound] >= value, then binary search the last step
+        size_t bound = 1;
+        while (j + bound < nb && b[j + bound] < value) bound <<= 1;
+        j = lower_bound(b + j, b + min(nb, j + bound + 1), value) - b;
+        if (j < nb && b[j] == value) {
+            if (out) out[count] = value;
+            count++;
+            j++;
+        }
+    }
+    return count;
+}
+
+size_t intersect_merge(const int* a, size_t na, const int* b, size_t nb, int* out) {
+    size_t count = 0, i = 0, j = 0;
+
+#if defined(__SSE2__)
+    // Compare a[i..i+4) with all four rotations of b[j..j+4): lane k of the
+    // mask is set iff a[i+k] occurs in the b block. Values are unique in each
+    // array, so every common value is reported exactly once.
+    while (i + 4 <= na && j + 4 <= nb) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+        __m128i eq = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi32(va, vb),
+                         _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)))),
+            _mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))),
+                         _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3)))));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+        if (mask) {
+            if (out) {
+                for (int k = 0; k < 4; ++k) {
+                    if (mask & (1 << k)) out[count++] = a[i + k];
+                }
+            } else {
+                count += __builtin_popcount(mask);
+            }
+        }
+
+        int lastA = a[i + 3], lastB = b[j + 3];
+        i += (lastA <= lastB) ? 4 : 0;
+        j += (lastB <= lastA) ? 4 : 0;
+    }
+#endif
+
+    // Scalar merge for the tails (or everything, without SSE2)
+    while (i < na && j < nb) {
+        int x = a[i], y = b[j];
+        if (x == y) {
+            if (out) out[count] = x;
+            count++;
+        }
+        i += (x <= y);
+        j += (y <= x);
+    }
+    return count;
+}
+
+}
+
+size_t intersect_sorted(const int* a, size_t na, const int* b, size_t nb, int* out) {
+    if (na > nb) {
+        swap(a, b);
+        swap(na, nb);
+    }
+    if (na == 0) return 0;
+    if (nb / na >= GALLOP_RATIO) return intersect_gallop(a, na, b, nb, out);
+    return intersect_merge(a, na, b, nb, out);
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+
+
+//Intersects two sorted, duplicate-free int arrays (e.g. two CSR neighbor rows).
+//Picks the kernel from the size ratio:
+//  - similar sizes: a merge that compares 4 x 4 blocks at a time with SSE2
+//    (a scalar merge on other targets), advancing whichever block ends first
+//  - one array much longer: galloping (exponential then binary search) into
+//    the longer one for each element of the shorter, O(small * log(large))
+//a, na First array and its length.
+//b, nb Second array and its length.
+//out If non-null, receives the common values in ascending order (room for
+//    min(na, nb) values is enough). Pass nullptr to only count.
+//Returns the number of common values.
+ 
+size_t intersect_sorted(const int* a, size_t na, const int* b, size_t nb, int* out = nullptr);
\ No newline at end of file
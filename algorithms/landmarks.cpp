@@ -0,0 +1,273 @@
+#include "landmarks.h"
+#include "msbfs.h"
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+
+using namespace std;
+
+namespace {
+
+const char MAGIC[8] = {'S', 'L', 'A', 'N', 'D', 'M', 'K', '\0'};
+const uint32_t FORMAT_VERSION = 2;
+
+// Fixed-size file header, followed by the landmark table (int32 [numLandmarks])
+// and the distance rows (uint16 [numUsers * numLandmarks]).
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t numLandmarks;
+    uint64_t numUsers;
+    uint64_t graphFingerprint; // GraphSnapshot::fingerprint() of the graph it was built on
+    uint64_t checksum;         // over this header (checksum = 0), the landmark table and the distance rows
+};
+
+uint64_t checksum_bytes(const void* data, size_t bytes, uint64_t hash = 0xcbf29ce484222325ULL) {
+    const unsigned char* bytePtr = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < bytes; ++i) {
+        hash ^= bytePtr[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// Covers the header too, so a flipped count or fingerprint fails validation.
+uint64_t checksum_file(FileHeader header, const string& payload) {
+    header.checksum = 0;
+    return checksum_bytes(payload.data(), payload.size(), checksum_bytes(&header, sizeof(header)));
+}
+
+bool fail(string* error, const string& reason) {
+    if (error) *error = reason;
+    return false;
+}
+
+}
+
+shared_ptr<const LandmarkOracle> LandmarkOracle::build(shared_ptr<const GraphSnapshot> graph, int numLandmarks) {
+    auto oracle = make_shared<LandmarkOracle>();
+    oracle->graph = graph;
+    oracle->graphFingerprint = graph->fingerprint();
+    int N = graph->num_users();
+
+    // --- 1. Pick landmarks: highest degree first, not next to an earlier pick ---
+    numLandmarks = max(1, min(numLandmarks, MultiSourceBFS::BATCH_WIDTH));
+    vector<int> byDegree(N);
+    for (int v = 0; v < N; ++v) byDegree[v] = v;
+    stable_sort(byDegree.begin(), byDegree.end(), [&](int a, int b) {
+        return graph->degree(a) > graph->degree(b);
+    });
+
+    vector<char> covered(N, 0);
+    for (int v : byDegree) {
+        if ((int)oracle->landmarks.size() == numLandmarks || graph->degree(v) == 0) break;
+        if (covered[v]) continue;
+        oracle->landmarks.push_back(v);
+        covered[v] = 1;
+        for (int w : graph->neighbors_of(v)) covered[w] = 1;
+    }
+    // Dense graphs can run out of uncovered users; top up with the next best
+    for (int v : byDegree) {
+        if ((int)oracle->landmarks.size() == numLandmarks || graph->degree(v) == 0) break;
+        if (find(oracle->landmarks.begin(), oracle->landmarks.end(), v) == oracle->landmarks.end()) {
+            oracle->landmarks.push_back(v);
+        }
+    }
+    int k = oracle->landmarks.size();
+    oracle->numLandmarks = k;
+
+    // --- 2. One multi-source BFS from all landmarks fills every row ---
+    oracle->distances.assign((size_t)N * k, UNREACHED);
+    if (k > 0) {
+        MultiSourceBFS bfs(*graph);
+        uint16_t* rows = oracle->distances.data();
+        bfs.run(oracle->landmarks.data(), k, [&](int vertex, int level, uint64_t reached) {
+            uint16_t hops = static_cast<uint16_t>(min(level, (int)SATURATED));
+            for (; reached; reached &= reached - 1) {
+                rows[(size_t)vertex * k + __builtin_ctzll(reached)] = hops;
+            }
+        });
+    }
+    return oracle;
+}
+
+HopEstimate LandmarkOracle::query(int userA, int userB) const {
+    HopEstimate estimate;
+    int a = graph->index_of(userA);
+    int b = graph->index_of(userB);
+    if (a == -1 || b == -1) return estimate;
+    if (a == b) {
+        estimate.known = estimate.connected = true;
+        return estimate;
+    }
+
+    const uint16_t* rowA = distances.data() + (size_t)a * numLandmarks;
+    const uint16_t* rowB = distances.data() + (size_t)b * numLandmarks;
+    int lower = 0;
+    int upper = -1;
+    bool saturated = false;
+    for (int l = 0; l < numLandmarks; ++l) {
+        bool reachesA = rowA[l] != UNREACHED;
+        bool reachesB = rowB[l] != UNREACHED;
+        if (reachesA != reachesB) {
+            // The landmark's component holds one user but not the other
+            estimate.known = true;
+            estimate.connected = false;
+            return estimate;
+        }
+        if (!reachesA) continue;
+        // A clamped distance would make both bounds too small
+        saturated = saturated || rowA[l] == SATURATED || rowB[l] == SATURATED;
+        lower = max(lower, abs(rowA[l] - rowB[l]));
+        int through = rowA[l] + rowB[l];
+        if (upper == -1 || through < upper) upper = through;
+    }
+
+    if (upper == -1 || saturated) return estimate; // no landmark in their component(s), or too far
+    estimate.known = estimate.connected = true;
+    estimate.lower = max(lower, 1);
+    estimate.upper = upper;
+    return estimate;
+}
+
+vector<int> LandmarkOracle::landmark_users() const {
+    vector<int> users;
+    for (int l : landmarks) users.push_back(graph->user_id(l));
+    return users;
+}
+
+bool LandmarkOracle::save(const string& path) const {
+    FileHeader header = {};
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.numLandmarks = numLandmarks;
+    header.numUsers = graph->num_users();
+    header.graphFingerprint = graphFingerprint;
+    size_t landmarkBytes = landmarks.size() * sizeof(int);
+    size_t distanceBytes = distances.size() * sizeof(uint16_t);
+    string payload(landmarkBytes + distanceBytes, '\0');
+    memcpy(&payload[0], landmarks.data(), landmarkBytes);
+    memcpy(&payload[landmarkBytes], distances.data(), distanceBytes);
+    header.checksum = checksum_file(header, payload);
+
+    // Write to a temporary file first so a crash never leaves half an index behind
+    string tmpFile = path + ".tmp";
+    ofstream out(tmpFile, ios::binary | ios::trunc);
+    if (!out.is_open()) {
+        cerr << "  Error: Could not open " << tmpFile << " for writing." << endl;
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(payload.data(), payload.size());
+    out.close();
+    if (!out) {
+        cerr << "  Error: Failed while writing " << tmpFile << "." << endl;
+        return false;
+    }
+
+    error_code ec;
+    filesystem::rename(tmpFile, path, ec);
+    if (ec) {
+        cerr << "  Error: Could not replace " << path << ": " << ec.message() << endl;
+        return false;
+    }
+    return true;
+}
+
+shared_ptr<const LandmarkOracle> LandmarkOracle::load(const string& path, shared_ptr<const GraphSnapshot> graph,
+                                                      string* error) {
+    ifstream in(path, ios::binary);
+    if (!in.is_open()) {
+        fail(error, "cannot open " + path);
+        return nullptr;
+    }
+
+    FileHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        fail(error, path + " is not a landmark index");
+        return nullptr;
+    }
+    if (header.version != FORMAT_VERSION) {
+        fail(error, path + " has format version " + to_string(header.version) +
+                    ", expected " + to_string(FORMAT_VERSION));
+        return nullptr;
+    }
+    if (header.numUsers != (uint64_t)graph->num_users() || header.graphFingerprint != graph->fingerprint()) {
+        fail(error, path + " was built for a different graph");
+        return nullptr;
+    }
+
+    // Bound the table before sizing anything from the (not yet verified) header
+    if (header.numLandmarks == 0 || header.numLandmarks > (uint32_t)MultiSourceBFS::BATCH_WIDTH) {
+        fail(error, path + " has an invalid landmark count (" + to_string(header.numLandmarks) + ")");
+        return nullptr;
+    }
+
+    auto oracle = make_shared<LandmarkOracle>();
+    oracle->graph = graph;
+    oracle->graphFingerprint = header.graphFingerprint;
+    oracle->numLandmarks = header.numLandmarks;
+    oracle->landmarks.resize(header.numLandmarks);
+    oracle->distances.resize(header.numUsers * header.numLandmarks);
+
+    size_t landmarkBytes = oracle->landmarks.size() * sizeof(int);
+    size_t distanceBytes = oracle->distances.size() * sizeof(uint16_t);
+    string payload(landmarkBytes + distanceBytes, '\0');
+    if (!in.read(&payload[0], payload.size()) || in.peek() != EOF) {
+        fail(error, path + " is truncated or has trailing data");
+        return nullptr;
+    }
+    if (checksum_file(header, payload) != header.checksum) {
+        fail(error, path + " failed its checksum (corrupt or partially written)");
+        return nullptr;
+    }
+    memcpy(oracle->landmarks.data(), payload.data(), landmarkBytes);
+    memcpy(oracle->distances.data(), payload.data() + landmarkBytes, distanceBytes);
+    for (int l : oracle->landmarks) {
+        if (l < 0 || l >= graph->num_users()) {
+            fail(error, path + " names a landmark outside the graph");
+            return nullptr;
+        }
+    }
+    return oracle;
+}
+
+shared_ptr<const LandmarkOracle> LandmarkOracleCache::get(const SocialNetwork& network) {
+    lock_guard<mutex> guard(lock);
+    if (current && version == network.get_version()) {
+        return current;
+    }
+
+    shared_ptr<const GraphSnapshot> graph = network.snapshot();
+    version = network.get_version();
+
+    // A saved index is still good if the graph is the same (e.g. after a restart)
+    if (!file.empty()) {
+        current = LandmarkOracle::load(file, graph);
+        if (current) return current;
+    }
+
+    current = LandmarkOracle::build(graph);
+    buildCount++;
+    if (!file.empty()) current->save(file);
+    return current;
+}
+
+void LandmarkOracleCache::set_file(const string& path) {
+    lock_guard<mutex> guard(lock);
+    file = path;
+}
+
+size_t LandmarkOracleCache::builds() const {
+    lock_guard<mutex> guard(lock);
+    return buildCount;
+}
+
+LandmarkOracleCache& LandmarkOracleCache::shared() {
+    static LandmarkOracleCache instance;
+    return instance;
+}
\ No newline at end of file
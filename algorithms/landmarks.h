@@ -0,0 +1,91 @@
+#pragma once
+
+using namespace std;
+#include "../SocialNetwork.h"
+#include "../GraphSnapshot.h"
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <cstdint>
+
+
+//Answer to a hop-count query from the landmark index.
+struct HopEstimate {
+    bool known = false;     // false if no landmark reaches either user, or a distance
+                            // was too long to store (ask BFS instead)
+    bool connected = false; // the users are in the same connected component
+    int lower = 0;          // the distance is at least this (only if connected)
+    int upper = 0;          // ... and at most this (a real path of this length exists)
+    bool exact() const { return known && (!connected || lower == upper); }
+};
+
+
+//Landmark distance index: exact hop counts from a few well-connected
+//"landmark" users to everyone, stored as one small row per user.
+//For users a and b and every landmark L (triangle inequality):
+//    |d(a,L) - d(b,L)|  <=  d(a,b)  <=  d(a,L) + d(L,b)
+//so a query is a scan of two rows. When the best lower and upper bounds meet
+//(e.g. one user is a landmark, or the path runs through one) the answer is exact.
+class LandmarkOracle {
+public:
+    //Builds the index: picks the highest-degree users as landmarks (skipping
+    //friends of landmarks already picked, so they spread out) and runs one
+    //multi-source BFS from all of them.
+    static shared_ptr<const LandmarkOracle> build(shared_ptr<const GraphSnapshot> graph, int numLandmarks = 16);
+
+    //Loads an index written by save(). Returns nullptr (and the reason in
+    //'error') if the file is missing, corrupt or was built for a different graph.
+    static shared_ptr<const LandmarkOracle> load(const string& path, shared_ptr<const GraphSnapshot> graph,
+                                                 string* error = nullptr);
+
+    //Writes the index next to the graph it was built from. Returns true on success.
+    bool save(const string& path) const;
+
+    //Bounds on the hop count between two users (by user ID).
+    HopEstimate query(int userA, int userB) const;
+
+    //The landmark users (by user ID).
+    vector<int> landmark_users() const;
+
+    //The snapshot this index describes.
+    const GraphSnapshot& snapshot() const { return *graph; }
+
+private:
+    static constexpr uint16_t UNREACHED = 0xFFFF;
+    static constexpr uint16_t SATURATED = 0xFFFE; // reached, but 65534 hops or more
+
+    shared_ptr<const GraphSnapshot> graph;
+    uint64_t graphFingerprint = 0;
+    int numLandmarks = 0;
+    vector<int> landmarks;      // dense indices
+    vector<uint16_t> distances; // [user * numLandmarks + landmark], UNREACHED if not connected,
+                                // SATURATED if too far to store
+};
+
+
+//Keeps the landmark index in step with the network.
+//Keyed by SocialNetwork::get_version(): the index is reused until the graph
+//changes, then rebuilt. If a file is set, a stale or missing index is first
+//looked for on disk (accepted only if its fingerprint matches the graph) and
+//every rebuilt index is written back.
+class LandmarkOracleCache {
+public:
+    //Gets the index for the network's current version, loading or building it on a miss.
+    shared_ptr<const LandmarkOracle> get(const SocialNetwork& network);
+
+    //Where to persist the index ("" = memory only).
+    void set_file(const string& path);
+
+    size_t builds() const;
+
+    //The process-wide instance used by the menu.
+    static LandmarkOracleCache& shared();
+
+private:
+    mutable mutex lock;
+    string file;
+    shared_ptr<const LandmarkOracle> current;
+    uint64_t version = 0;
+    size_t buildCount = 0;
+};
\ No newline at end of file
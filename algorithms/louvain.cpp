@@ -0,0 +1,315 @@
+#include "louvain.h"
+#include "../LogManager.h"
+#include "../Parallel.h"
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+using namespace std;
+
+// Local moving: vertices are split into this many interleaved batches. Moves are
+// chosen in parallel within a batch and applied between batches, so the result
+// does not depend on the thread count and neighbors rarely move at the same time.
+static const int MOVE_BATCHES = 16;
+static const int MAX_SWEEPS = 32;
+static const int MAX_LEVELS = 16;
+static const double MIN_MODULARITY_GAIN = 1e-6;
+
+namespace {
+
+// Compact weighted graph for one Louvain level, in CSR form.
+// A self-loop holds the weight already inside a vertex (twice its internal
+// edges), so degrees and the total weight carry over between levels unchanged.
+struct WeightedGraph {
+    int n = 0;
+    vector<uint64_t> offsets;
+    vector<int> targets;
+    vector<double> weights;
+    vector<double> degree;    // weighted degree k_v, self-loop included
+    double totalWeight = 0.0; // 2m = sum of all degrees
+};
+
+WeightedGraph from_snapshot(const GraphSnapshot& graph) {
+    WeightedGraph g;
+    g.n = graph.num_users();
+    g.offsets.assign(graph.offsets(), graph.offsets() + g.n + 1);
+    g.targets.assign(graph.neighbors(), graph.neighbors() + g.offsets[g.n]);
+    g.weights.assign(g.targets.size(), 1.0);
+    g.degree.resize(g.n);
+    for (int v = 0; v < g.n; ++v) {
+        g.degree[v] = graph.degree(v);
+    }
+    g.totalWeight = static_cast<double>(g.targets.size());
+    return g;
+}
+
+// Weight from one vertex to each neighboring community. An open-addressing table
+// sized to the largest degree, so per-thread scratch does not grow with the
+// number of communities; occupied slots are listed in first-touch order.
+struct CommunityWeights {
+    vector<int> keys;      // community, or -1 for an empty slot
+    vector<double> values;
+    vector<int> used;      // occupied slots
+    uint32_t mask = 0;
+
+    explicit CommunityWeights(size_t maxEntries = 0) {
+        size_t capacity = 16;
+        while (capacity < 2 * maxEntries) capacity <<= 1; // at most half full
+        keys.assign(capacity, -1);
+        values.assign(capacity, 0.0);
+        mask = static_cast<uint32_t>(capacity - 1);
+    }
+
+    double& operator[](int c) {
+        uint32_t slot = find_slot(c);
+        if (keys[slot] == -1) {
+            keys[slot] = c;
+            values[slot] = 0.0;
+            used.push_back(slot);
+        }
+        return values[slot];
+    }
+
+    double get(int c) const {
+        uint32_t slot = find_slot(c);
+        return keys[slot] == -1 ? 0.0 : values[slot];
+    }
+
+    void clear() {
+        for (int slot : used) keys[slot] = -1;
+        used.clear();
+    }
+
+private:
+    uint32_t find_slot(int c) const {
+        uint32_t slot = (static_cast<uint32_t>(c) * 2654435761u) & mask;
+        while (keys[slot] != -1 && keys[slot] != c) slot = (slot + 1) & mask;
+        return slot;
+    }
+};
+
+// Q = sum over communities c of  in_c / 2m - (tot_c / 2m)^2
+double modularity(const WeightedGraph& g, const vector<int>& community) {
+    vector<double> inside(g.n, 0.0), total(g.n, 0.0);
+    for (int v = 0; v < g.n; ++v) {
+        total[community[v]] += g.degree[v];
+        for (uint64_t e = g.offsets[v]; e < g.offsets[v + 1]; ++e) {
+            if (community[g.targets[e]] == community[v]) inside[community[v]] += g.weights[e];
+        }
+    }
+    double q = 0.0;
+    for (int c = 0; c < g.n; ++c) {
+        double share = total[c] / g.totalWeight;
+        q += inside[c] / g.totalWeight - share * share;
+    }
+    return q;
+}
+
+// Moves vertices between communities while it raises modularity.
+// Returns the number of sweeps run.
+int move_vertices(const WeightedGraph& g, vector<int>& community, int threads) {
+    vector<double> total(g.degree); // every vertex starts alone
+    vector<int> target(g.n);
+
+    int T = max(1, min(threads, g.n / (MOVE_BATCHES * 64) + 1));
+    // Per-thread tables: weight from the current vertex to each community
+    uint64_t maxDegree = 0;
+    for (int v = 0; v < g.n; ++v) {
+        maxDegree = max(maxDegree, g.offsets[v + 1] - g.offsets[v]);
+    }
+    vector<CommunityWeights> linkWeight(T, CommunityWeights(maxDegree));
+
+    double lastQ = modularity(g, community);
+    int sweep = 0;
+    while (sweep < MAX_SWEEPS) {
+        sweep++;
+        long long moved = 0;
+
+        for (int batch = 0; batch < MOVE_BATCHES; ++batch) {
+            int batchSize = g.n > batch ? (g.n - batch + MOVE_BATCHES - 1) / MOVE_BATCHES : 0;
+
+            // --- 1. Pick the best community for every vertex of the batch (in parallel) ---
+            run_in_parallel(T, [&](int t) {
+                CommunityWeights& weightTo = linkWeight[t];
+                int first = (long long)batchSize * t / T;
+                int last = (long long)batchSize * (t + 1) / T;
+
+                for (int i = first; i < last; ++i) {
+                    int v = batch + i * MOVE_BATCHES;
+                    int own = community[v];
+                    for (uint64_t e = g.offsets[v]; e < g.offsets[v + 1]; ++e) {
+                        int u = g.targets[e];
+                        if (u == v) continue; // the self-loop moves with v
+                        weightTo[community[u]] += g.weights[e];
+                    }
+
+                    // Gain of joining c (after leaving 'own'): k_v,c - tot_c * k_v / 2m
+                    double ki = g.degree[v];
+                    double scale = ki / g.totalWeight;
+                    int best = own;
+                    double bestGain = weightTo.get(own) - (total[own] - ki) * scale;
+                    for (int slot : weightTo.used) {
+                        int c = weightTo.keys[slot];
+                        if (c == own) continue;
+                        double gain = weightTo.values[slot] - total[c] * scale;
+                        if (gain > bestGain + 1e-12 || (gain > bestGain - 1e-12 && best != own && c < best)) {
+                            best = c;
+                            bestGain = gain;
+                        }
+                    }
+                    target[v] = best;
+
+                    weightTo.clear();
+                }
+            });
+
+            // --- 2. Apply the moves ---
+            for (int i = 0; i < batchSize; ++i) {
+                int v = batch + i * MOVE_BATCHES;
+                if (target[v] == community[v]) continue;
+                total[community[v]] -= g.degree[v];
+                total[target[v]] += g.degree[v];
+                community[v] = target[v];
+                moved++;
+            }
+        }
+
+        // Simultaneous moves inside a batch can keep a few vertices swapping
+        // back and forth forever, so stop once a sweep no longer pays off
+        if (moved == 0) break;
+        double q = modularity(g, community);
+        if (q < lastQ + MIN_MODULARITY_GAIN) break;
+        lastQ = q;
+    }
+    return sweep;
+}
+
+// Splits every community into its connected pieces (splitting a disconnected
+// community always raises modularity) and renumbers them 0 .. C-1.
+// Returns C.
+int split_disconnected(const WeightedGraph& g, vector<int>& community) {
+    vector<int> piece(g.n, -1);
+    vector<int> bfsQueue(g.n);
+    int pieces = 0;
+    for (int root = 0; root < g.n; ++root) {
+        if (piece[root] != -1) continue;
+        int head = 0, tail = 0;
+        piece[root] = pieces;
+        bfsQueue[tail++] = root;
+        while (head < tail) {
+            int v = bfsQueue[head++];
+            for (uint64_t e = g.offsets[v]; e < g.offsets[v + 1]; ++e) {
+                int u = g.targets[e];
+                if (piece[u] == -1 && community[u] == community[root]) {
+                    piece[u] = pieces;
+                    bfsQueue[tail++] = u;
+                }
+            }
+        }
+        pieces++;
+    }
+    community.swap(piece);
+    return pieces;
+}
+
+// Collapses every community into a single vertex of the next level.
+WeightedGraph aggregate(const WeightedGraph& g, const vector<int>& community, int numCommunities) {
+    // Group the vertices by community (counting sort)
+    vector<int> start(numCommunities + 1, 0), members(g.n);
+    for (int v = 0; v < g.n; ++v) start[community[v] + 1]++;
+    for (int c = 0; c < numCommunities; ++c) start[c + 1] += start[c];
+    vector<int> cursor = start;
+    for (int v = 0; v < g.n; ++v) members[cursor[community[v]]++] = v;
+
+    WeightedGraph coarse;
+    coarse.n = numCommunities;
+    coarse.offsets.assign(numCommunities + 1, 0);
+    coarse.degree.assign(numCommunities, 0.0);
+    coarse.totalWeight = g.totalWeight;
+
+    vector<double> weightTo(numCommunities, 0.0);
+    vector<int> seen;
+    for (int c = 0; c < numCommunities; ++c) {
+        for (int i = start[c]; i < start[c + 1]; ++i) {
+            int v = members[i];
+            coarse.degree[c] += g.degree[v];
+            for (uint64_t e = g.offsets[v]; e < g.offsets[v + 1]; ++e) {
+                int other = community[g.targets[e]];
+                if (weightTo[other] == 0.0) seen.push_back(other);
+                weightTo[other] += g.weights[e];
+            }
+        }
+        sort(seen.begin(), seen.end());
+        for (int other : seen) {
+            coarse.targets.push_back(other);
+            coarse.weights.push_back(weightTo[other]);
+            weightTo[other] = 0.0;
+        }
+        seen.clear();
+        coarse.offsets[c + 1] = coarse.targets.size();
+    }
+    return coarse;
+}
+
+}
+
+unordered_map<int, int> detect_communities_louvain(const SocialNetwork& network, int threads, LouvainStats* stats) {
+    return detect_communities_louvain(*network.snapshot(), threads, stats);
+}
+
+unordered_map<int, int> detect_communities_louvain(const GraphSnapshot& graph, int threads, LouvainStats* stats) {
+    int N = graph.num_users();
+    LouvainStats report;
+
+    // membership[v]: the vertex of the current level that user v has been merged into
+    vector<int> membership(N);
+    for (int v = 0; v < N; ++v) membership[v] = v;
+
+    WeightedGraph level = from_snapshot(graph);
+    if (level.totalWeight > 0) {
+        vector<int> singletons(N);
+        for (int v = 0; v < N; ++v) singletons[v] = v;
+        double q = modularity(level, singletons);
+        int T = max(1, resolve_thread_count(threads));
+
+        for (int depth = 0; depth < MAX_LEVELS; ++depth) {
+            // --- 1. Local moving, then split anything left disconnected ---
+            vector<int> community(level.n);
+            for (int v = 0; v < level.n; ++v) community[v] = v;
+            int sweeps = move_vertices(level, community, T);
+            int numCommunities = split_disconnected(level, community);
+
+            // --- 2. Keep the level only if it merged something and helped ---
+            double levelQ = modularity(level, community);
+            if (numCommunities == level.n || levelQ < q + MIN_MODULARITY_GAIN) break;
+
+            for (int v = 0; v < N; ++v) membership[v] = community[membership[v]];
+            q = levelQ;
+            report.levels++;
+            report.modularity.push_back(q);
+            report.communities.push_back(numCommunities);
+            report.sweeps.push_back(sweeps);
+
+            // --- 3. Coarsen: each community becomes one vertex ---
+            level = aggregate(level, community, numCommunities);
+        }
+    }
+
+    // --- 4. Name each community after its lowest UserID ---
+    // (dense indices follow ascending UserID, so the first member seen is the lowest)
+    vector<int> label(N, -1);
+    unordered_map<int, int> result;
+    result.reserve(N);
+    for (int v = 0; v < N; ++v) {
+        int& name = label[membership[v]];
+        if (name == -1) name = graph.user_id(v);
+        result[graph.user_id(v)] = name;
+        if (name != graph.user_id(v)) {
+            LogManager::log("recolor", graph.user_id(v), -1, name);
+        }
+    }
+
+    if (stats) *stats = report;
+    return result;
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+
+using namespace std;
+#include "../SocialNetwork.h"
+#include "../GraphSnapshot.h"
+#include <unordered_map>
+#include <vector>
+
+
+//Per-level report for one Louvain run.
+struct LouvainStats {
+    int levels = 0;                 // coarsening levels run
+    vector<double> modularity;      // modularity after each level
+    vector<int> communities;        // number of communities after each level
+    vector<int> sweeps;             // local-moving sweeps in each level
+};
+
+
+//Detects communities with the Louvain method (Blondel et al.).
+//Each level moves users (or, on later levels, whole communities) to the
+//neighboring community with the best modularity gain until nothing improves,
+//splits any community that ended up disconnected (as Leiden guarantees), and
+//then coarsens: every community becomes one weighted vertex of the next level.
+//Stops when a level no longer merges anything or modularity stops rising.
+//network The populated SocialNetwork object.
+//threads Worker threads for the moving phase (0 = one per hardware thread).
+//stats If non-null, receives the modularity and community count per level.
+//Returns an unordered_map<int, int> mapping UserID to its CommunityID
+//(the lowest UserID in the community), like detect_communities.
+ 
+unordered_map<int, int> detect_communities_louvain(
+    const SocialNetwork& network,
+    int threads = 0,
+    LouvainStats* stats = nullptr
+);
+
+
+//Same as above, but runs directly on a frozen CSR snapshot of the network.
+ 
+unordered_map<int, int> detect_communities_louvain(
+    const GraphSnapshot& graph,
+    int threads = 0,
+    LouvainStats* stats = nullptr
+);
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include "minhash.h"
+#include "../Parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+using namespace std;
+
+namespace {
+
+// Users are handed out to threads in blocks of this size
+const int USER_BLOCK = 1024;
+
+// 64-bit finalizer (splitmix64): turns (seed ^ tag ID) into an independent-looking hash
+inline uint64_t mix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+}
+
+shared_ptr<const TagLSHIndex> TagLSHIndex::build(const SocialNetwork& network, int bands, int rows,
+                                                 int threads, uint64_t seed) {
+    auto index = make_shared<TagLSHIndex>();
+    index->numBands = max(1, bands);
+    index->numRows = max(1, rows);
+    int H = index->numBands * index->numRows;
+
+    // --- 1. Tagged users, sorted so slots (and bucket order) are deterministic ---
+    for (int userID : network.get_all_users()) {
+        if (!network.get_tag_ids(userID).empty()) index->userIDs.push_back(userID);
+    }
+    sort(index->userIDs.begin(), index->userIDs.end());
+    int N = index->userIDs.size();
+
+    // --- 2. Signatures: per hash function, the minimum hash over the user's tags ---
+    vector<uint64_t> functionSeeds(H);
+    for (int i = 0; i < H; ++i) {
+        functionSeeds[i] = mix64(seed + i);
+    }
+    index->signatures.assign(static_cast<size_t>(N) * H, UINT32_MAX);
+
+    int numBlocks = (N + USER_BLOCK - 1) / USER_BLOCK;
+    int T = max(1, min(resolve_thread_count(threads), numBlocks));
+    atomic<int> next_block(0);
+    run_in_parallel(T, [&](int) {
+        while (true) {
+            int block = next_block.fetch_add(1);
+            if (block >= numBlocks) break;
+            int last = min(N, (block + 1) * USER_BLOCK);
+            for (int s = block * USER_BLOCK; s < last; ++s) {
+                uint32_t* signature = index->signatures.data() + static_cast<size_t>(s) * H;
+                for (int tagID : network.get_tag_ids(index->userIDs[s])) {
+                    for (int i = 0; i < H; ++i) {
+                        uint32_t value = static_cast<uint32_t>(mix64(functionSeeds[i] ^ static_cast<uint64_t>(tagID)));
+                        signature[i] = min(signature[i], value);
+                    }
+                }
+            }
+        }
+    });
+
+    // --- 3. Buckets: one hash table per band (bands are independent, so split them across threads) ---
+    index->buckets.resize(index->numBands);
+    int bandThreads = max(1, min(resolve_thread_count(threads), index->numBands));
+    run_in_parallel(bandThreads, [&](int t) {
+        for (int band = t; band < index->numBands; band += bandThreads) {
+            auto& table = index->buckets[band];
+            table.reserve(N);
+            for (int s = 0; s < N; ++s) {
+                table[index->band_key(s, band)].push_back(s);
+            }
+        }
+    });
+    return index;
+}
+
+void TagLSHIndex::candidates(int userID, vector<int>& out) const {
+    out.clear();
+    int slot = slot_of(userID);
+    if (slot == -1) return;
+
+    for (int band = 0; band < numBands; ++band) {
+        auto it = buckets[band].find(band_key(slot, band));
+        if (it == buckets[band].end()) continue;
+        for (int other : it->second) {
+            if (other != slot) out.push_back(other);
+        }
+    }
+
+    // A user can share several bands with us; slots are in user ID order
+    sort(out.begin(), out.end());
+    out.erase(unique(out.begin(), out.end()), out.end());
+    for (int& candidate : out) {
+        candidate = userIDs[candidate];
+    }
+}
+
+double TagLSHIndex::estimate_jaccard(int userA, int userB) const {
+    int a = slot_of(userA), b = slot_of(userB);
+    if (a == -1 || b == -1) return 0.0;
+    int H = numBands * numRows;
+    const uint32_t* sigA = signatures.data() + static_cast<size_t>(a) * H;
+    const uint32_t* sigB = signatures.data() + static_cast<size_t>(b) * H;
+    int matches = 0;
+    for (int i = 0; i < H; ++i) {
+        matches += (sigA[i] == sigB[i]);
+    }
+    return static_cast<double>(matches) / H;
+}
+
+double TagLSHIndex::threshold() const {
+    return pow(1.0 / numBands, 1.0 / numRows);
+}
+
+int TagLSHIndex::slot_of(int userID) const {
+    auto it = lower_bound(userIDs.begin(), userIDs.end(), userID);
+    if (it == userIDs.end() || *it != userID) return -1;
+    return static_cast<int>(it - userIDs.begin());
+}
+
+uint64_t TagLSHIndex::band_key(int slot, int band) const {
+    const uint32_t* values = signatures.data() + static_cast<size_t>(slot) * numBands * numRows + band * numRows;
+    uint64_t key = 0;
+    for (int r = 0; r < numRows; ++r) {
+        key = mix64(key ^ values[r]);
+    }
+    return key;
+}
\ No newline at end of file
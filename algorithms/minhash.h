@@ -0,0 +1,56 @@
+#pragma once
+
+using namespace std;
+#include "../SocialNetwork.h"
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <cstdint>
+
+
+//MinHash + LSH banding index over users' interned tag sets.
+//Every user with tags gets a signature of bands * rows MinHash values; two
+//users agree on one value with probability equal to their tag Jaccard. The
+//signature is cut into 'bands' groups of 'rows' values, and users whose values
+//match in a whole band land in the same bucket. A pair with Jaccard s shares
+//at least one bucket with probability 1 - (1 - s^rows)^bands, an S-curve that
+//rises around threshold() = (1/bands)^(1/rows):
+//  - more rows per band  -> fewer, more similar candidates (faster, lower recall)
+//  - more bands          -> more candidates (slower, higher recall)
+//Built once for a network version; it does not follow later add_user calls.
+class TagLSHIndex {
+public:
+    //Hashes every tagged user of the network.
+    //bands Number of LSH bands.
+    //rows MinHash values per band.
+    //threads Worker threads (0 = one per hardware thread).
+    static shared_ptr<const TagLSHIndex> build(const SocialNetwork& network, int bands = 16, int rows = 4,
+                                               int threads = 0, uint64_t seed = 42);
+
+    //Users sharing at least one band bucket with userID (userID itself excluded),
+    //sorted by user ID. Empty if userID has no tags or was not indexed.
+    void candidates(int userID, vector<int>& out) const;
+
+    //Fraction of matching signature values: an unbiased estimate of the tag Jaccard.
+    //Returns 0 if either user was not indexed.
+    double estimate_jaccard(int userA, int userB) const;
+
+    int bands() const { return numBands; }
+    int rows() const { return numRows; }
+
+    //Jaccard at which a pair becomes more likely than not to be a candidate (roughly).
+    double threshold() const;
+
+    //Number of indexed (tagged) users.
+    size_t size() const { return userIDs.size(); }
+
+private:
+    int numBands = 0;
+    int numRows = 0;
+    vector<int> userIDs;          // indexed users, sorted (slot -> user ID)
+    vector<uint32_t> signatures;  // [slot * bands * rows + i]
+    vector<unordered_map<uint64_t, vector<int>>> buckets; // per band: band key -> slots
+
+    int slot_of(int userID) const;
+    uint64_t band_key(int slot, int band) const;
+};
\ No newline at end of file
@@ -0,0 +1,6 @@
+#include "msbfs.h"
+
+using namespace std;
+
+MultiSourceBFS::MultiSourceBFS(const GraphSnapshot& graph)
+    : graph(graph), seen(graph.num_users(), 0), frontier(graph.num_users(), 0), next(graph.num_users(), 0) {}
\ No newline at end of file
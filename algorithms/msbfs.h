@@ -0,0 +1,119 @@
+#pragma once
+
+using namespace std;
+#include "../GraphSnapshot.h"
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+
+//Multi-source BFS (MS-BFS, Then et al.): runs BFS from up to 64 sources at once.
+//Each vertex keeps a 64-bit mask per set -- bit i stands for the i-th source of
+//the batch -- so one scan of an edge advances every source whose frontier
+//contains it, instead of once per source. The frontier is also kept as a list
+//of vertices, so a small level only touches the edges of the vertices on it
+//and a batch scans each edge of its component once.
+//The workspace holds the masks; reuse one per thread to avoid reallocating.
+class MultiSourceBFS {
+public:
+    //Largest number of sources in one batch (bits in a mask).
+    static constexpr int BATCH_WIDTH = 64;
+
+    //A level whose frontier holds fewer than 1/SPARSE_FRONTIER_RATIO of the
+    //vertices is expanded from the frontier list instead of a full pass.
+    static constexpr size_t SPARSE_FRONTIER_RATIO = 32;
+
+    explicit MultiSourceBFS(const GraphSnapshot& graph);
+
+    //Runs the BFS from sources[0 .. count-1] (dense indices, count <= BATCH_WIDTH).
+    //visit(vertex, level, reached) is called once per level for each vertex that
+    //some sources first reach at that level; bit i of 'reached' means sources[i]
+    //is at distance 'level' from it. Level 0 reports the sources themselves.
+    //Levels are reported in increasing order; vertices within a level are not.
+    template <typename Visitor>
+    void run(const int* sources, int count, Visitor visit);
+
+private:
+    const GraphSnapshot& graph;
+    vector<uint64_t> seen;      // sources that have reached each vertex
+    vector<uint64_t> frontier;  // sources that reached each vertex in the last level
+    vector<uint64_t> next;      // sources that reach each vertex in the coming level
+    vector<int> frontierList;   // vertices with a non-zero frontier mask
+    vector<int> nextList;       // vertices with a non-zero next mask (sparse levels only)
+    vector<int> reachedList;    // vertices with a non-zero seen mask (to reset them)
+};
+
+template <typename Visitor>
+void MultiSourceBFS::run(const int* sources, int count, Visitor visit) {
+    frontierList.clear();
+    reachedList.clear();
+
+    // --- 1. Level 0: every source has only reached itself ---
+    for (int i = 0; i < count; ++i) {
+        int v = sources[i];
+        if (seen[v] == 0) {
+            frontierList.push_back(v);
+            reachedList.push_back(v);
+        }
+        uint64_t bit = uint64_t(1) << i;
+        seen[v] |= bit;
+        frontier[v] |= bit;
+    }
+    for (int v : frontierList) {
+        visit(v, 0, frontier[v]);
+    }
+
+    // --- 2. Expand all frontiers together, one level at a time ---
+    int N = graph.num_users();
+    for (int level = 1; !frontierList.empty(); ++level) {
+        // A small frontier is walked from its list; a large one (the usual case
+        // with 64 sources) by one sequential pass, which the cache handles better
+        bool sparse = frontierList.size() * SPARSE_FRONTIER_RATIO < (size_t)N;
+
+        // Push each frontier vertex's mask to its neighbors (one pass over their edges)
+        nextList.clear();
+        if (sparse) {
+            for (int v : frontierList) {
+                uint64_t mask = frontier[v];
+                frontier[v] = 0;
+                for (int w : graph.neighbors_of(v)) {
+                    if ((mask & ~seen[w]) == 0) continue; // nothing new for w
+                    if (next[w] == 0) nextList.push_back(w);
+                    next[w] |= mask;
+                }
+            }
+        } else {
+            for (int v = 0; v < N; ++v) {
+                uint64_t mask = frontier[v];
+                if (mask == 0) continue;
+                frontier[v] = 0;
+                for (int w : graph.neighbors_of(v)) {
+                    next[w] |= mask;
+                }
+            }
+        }
+
+        // Keep only the sources that had not reached the vertex yet
+        frontierList.clear();
+        auto settle = [&](int v) {
+            uint64_t reached = next[v] & ~seen[v];
+            next[v] = 0;
+            if (reached == 0) return; // only sources that were already there
+            if (seen[v] == 0) reachedList.push_back(v);
+            seen[v] |= reached;
+            frontier[v] = reached;
+            frontierList.push_back(v);
+            visit(v, level, reached);
+        };
+        if (sparse) {
+            for (int v : nextList) settle(v);
+        } else {
+            for (int v = 0; v < N; ++v) {
+                if (next[v]) settle(v);
+            }
+        }
+    }
+
+    // Leave the masks zeroed for the next batch
+    for (int v : reachedList) seen[v] = 0;
+}
\ No newline at end of file
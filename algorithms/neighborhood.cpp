@@ -0,0 +1,166 @@
+#include "neighborhood.h"
+#include "intersect.h"
+#include "../Parallel.h"
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace {
+
+// Pairs / users are handed out to threads in blocks of these sizes
+const int PAIR_BLOCK = 256;
+const int USER_BLOCK = 64;
+
+int max_degree(const GraphSnapshot& graph) {
+    int result = 0;
+    for (int v = 0; v < graph.num_users(); ++v) {
+        result = max(result, graph.degree(v));
+    }
+    return result;
+}
+
+// Adamic-Adar from the common neighbors already written to 'common'
+double adamic_adar_with(const GraphSnapshot& graph, int u, int v, vector<int>& common) {
+    auto rowU = graph.neighbors_of(u), rowV = graph.neighbors_of(v);
+    size_t count = intersect_sorted(rowU.begin(), rowU.size(), rowV.begin(), rowV.size(), common.data());
+    double score = 0.0;
+    for (size_t k = 0; k < count; ++k) {
+        int degree = graph.degree(common[k]);
+        if (degree > 1) score += 1.0 / log(degree);
+    }
+    return score;
+}
+
+// Runs fn(i, scratch) for every pair index across threads; 'scratch' has room for any row
+template <typename Fn>
+void for_each_pair(const GraphSnapshot& graph, size_t numPairs, int threads, bool needScratch, Fn fn) {
+    int numBlocks = static_cast<int>((numPairs + PAIR_BLOCK - 1) / PAIR_BLOCK);
+    int T = max(1, min(resolve_thread_count(threads), numBlocks));
+    int scratchSize = needScratch ? max_degree(graph) : 0;
+    atomic<int> next_block(0);
+
+    run_in_parallel(T, [&](int) {
+        vector<int> scratch(scratchSize);
+        while (true) {
+            int block = next_block.fetch_add(1);
+            if (block >= numBlocks) break;
+            size_t first = static_cast<size_t>(block) * PAIR_BLOCK;
+            size_t last = min(numPairs, first + PAIR_BLOCK);
+            for (size_t i = first; i < last; ++i) fn(i, scratch);
+        }
+    });
+}
+
+}
+
+int common_neighbors(const GraphSnapshot& graph, int u, int v) {
+    auto rowU = graph.neighbors_of(u), rowV = graph.neighbors_of(v);
+    return static_cast<int>(intersect_sorted(rowU.begin(), rowU.size(), rowV.begin(), rowV.size()));
+}
+
+int common_neighbors(const SocialNetwork& network, int userA, int userB) {
+    auto graph = network.snapshot();
+    int u = graph->index_of(userA), v = graph->index_of(userB);
+    if (u == -1 || v == -1) return 0;
+    return common_neighbors(*graph, u, v);
+}
+
+double adamic_adar(const GraphSnapshot& graph, int u, int v) {
+    vector<int> common(min(graph.degree(u), graph.degree(v)));
+    return adamic_adar_with(graph, u, v, common);
+}
+
+double adamic_adar(const SocialNetwork& network, int userA, int userB) {
+    auto graph = network.snapshot();
+    int u = graph->index_of(userA), v = graph->index_of(userB);
+    if (u == -1 || v == -1) return 0.0;
+    return adamic_adar(*graph, u, v);
+}
+
+vector<int> common_neighbors_batch(const GraphSnapshot& graph, const vector<pair<int, int>>& pairs, int threads) {
+    vector<int> result(pairs.size());
+    for_each_pair(graph, pairs.size(), threads, false, [&](size_t i, vector<int>&) {
+        result[i] = common_neighbors(graph, pairs[i].first, pairs[i].second);
+    });
+    return result;
+}
+
+vector<double> adamic_adar_batch(const GraphSnapshot& graph, const vector<pair<int, int>>& pairs, int threads) {
+    vector<double> result(pairs.size());
+    for_each_pair(graph, pairs.size(), threads, true, [&](size_t i, vector<int>& scratch) {
+        result[i] = adamic_adar_with(graph, pairs[i].first, pairs[i].second, scratch);
+    });
+    return result;
+}
+
+vector<long long> count_triangles(const GraphSnapshot& graph, int threads, TriangleStats* stats) {
+    int N = graph.num_users();
+    vector<long long> triangles(N, 0);
+    if (N == 0) {
+        if (stats) *stats = TriangleStats();
+        return triangles;
+    }
+
+    // --- 1. Each triangle u < v < w once, from u (v and w are credited atomically) ---
+    int numBlocks = (N + USER_BLOCK - 1) / USER_BLOCK;
+    int T = max(1, min(resolve_thread_count(threads), numBlocks));
+    int scratchSize = max_degree(graph);
+    atomic<int> next_block(0);
+
+    run_in_parallel(T, [&](int) {
+        vector<int> common(scratchSize);
+        while (true) {
+            int block = next_block.fetch_add(1);
+            if (block >= numBlocks) break;
+            int last = min(N, (block + 1) * USER_BLOCK);
+            for (int u = block * USER_BLOCK; u < last; ++u) {
+                auto rowU = graph.neighbors_of(u);
+                long long found = 0;
+                for (const int* it = upper_bound(rowU.begin(), rowU.end(), u); it != rowU.end(); ++it) {
+                    int v = *it;
+                    // Only the parts of both rows above v can hold w
+                    const int* restU = it + 1;
+                    auto rowV = graph.neighbors_of(v);
+                    const int* restV = upper_bound(rowV.begin(), rowV.end(), v);
+                    size_t count = intersect_sorted(restU, rowU.end() - restU, restV, rowV.end() - restV,
+                                                    common.data());
+                    if (count == 0) continue;
+                    found += count;
+                    __atomic_fetch_add(&triangles[v], static_cast<long long>(count), __ATOMIC_RELAXED);
+                    for (size_t k = 0; k < count; ++k) {
+                        __atomic_fetch_add(&triangles[common[k]], 1LL, __ATOMIC_RELAXED);
+                    }
+                }
+                if (found > 0) __atomic_fetch_add(&triangles[u], found, __ATOMIC_RELAXED);
+            }
+        }
+    });
+
+    // --- 2. Summary ---
+    if (stats) {
+        long long total = 0;
+        double triples = 0.0, clusteringSum = 0.0;
+        vector<double> clustering = local_clustering(graph, triangles);
+        for (int v = 0; v < N; ++v) {
+            total += triangles[v];
+            double d = graph.degree(v);
+            triples += d * (d - 1) / 2;
+            clusteringSum += clustering[v];
+        }
+        stats->triangles = total / 3;
+        stats->transitivity = triples > 0 ? 3.0 * stats->triangles / triples : 0.0;
+        stats->averageClustering = clusteringSum / N;
+    }
+    return triangles;
+}
+
+vector<double> local_clustering(const GraphSnapshot& graph, const vector<long long>& triangles) {
+    vector<double> clustering(graph.num_users(), 0.0);
+    for (int v = 0; v < graph.num_users(); ++v) {
+        double d = graph.degree(v);
+        if (d >= 2) clustering[v] = triangles[v] / (d * (d - 1) / 2);
+    }
+    return clustering;
+}
\ No newline at end of file
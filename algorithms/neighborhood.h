@@ -0,0 +1,69 @@
+#pragma once
+
+using namespace std;
+#include "../SocialNetwork.h"
+#include "../GraphSnapshot.h"
+#include <vector>
+#include <utility>
+
+
+//Pairwise neighborhood scores and triangle counts, all computed by
+//intersecting sorted CSR neighbor rows (see intersect_sorted) instead of
+//hash lookups.
+
+
+//Number of friends two users have in common.
+//graph The CSR snapshot; u, v Dense indices.
+ 
+int common_neighbors(const GraphSnapshot& graph, int u, int v);
+
+
+//Same as above, by user ID. Returns 0 if either user does not exist.
+ 
+int common_neighbors(const SocialNetwork& network, int userA, int userB);
+
+
+//Adamic-Adar index of a pair: the sum of 1 / log(degree) over their common
+//friends (the score recommend_by_proximity accumulates for a candidate,
+//up to floating-point summation order).
+//graph The CSR snapshot; u, v Dense indices.
+ 
+double adamic_adar(const GraphSnapshot& graph, int u, int v);
+
+
+//Same as above, by user ID. Returns 0 if either user does not exist.
+ 
+double adamic_adar(const SocialNetwork& network, int userA, int userB);
+
+
+//Batched versions, e.g. for rescoring a candidate list: one result per
+//(u, v) pair of dense indices, computed across threads.
+//threads Worker threads (0 = one per hardware thread).
+ 
+vector<int> common_neighbors_batch(const GraphSnapshot& graph, const vector<pair<int, int>>& pairs, int threads = 0);
+vector<double> adamic_adar_batch(const GraphSnapshot& graph, const vector<pair<int, int>>& pairs, int threads = 0);
+
+
+//Network-wide triangle summary.
+struct TriangleStats {
+    long long triangles = 0;        // distinct triangles (friend trios)
+    double transitivity = 0.0;      // 3 * triangles / connected triples (global clustering)
+    double averageClustering = 0.0; // mean local clustering over all users (degree < 2 counts as 0)
+};
+
+
+//Counts the triangles through every user. Each triangle u < v < w is found
+//once, from u, by intersecting the parts of N(u) and N(v) above v.
+//graph The CSR snapshot.
+//threads Worker threads (0 = one per hardware thread).
+//stats If non-null, receives the network-wide summary.
+//Returns triangles per user, indexed by dense index.
+ 
+vector<long long> count_triangles(const GraphSnapshot& graph, int threads = 0, TriangleStats* stats = nullptr);
+
+
+//Local clustering coefficient per user: the fraction of pairs of their
+//friends who are friends themselves (0 for degree < 2).
+//triangles Per-user triangle counts from count_triangles.
+ 
+vector<double> local_clustering(const GraphSnapshot& graph, const vector<long long>& triangles);
\ No newline at end of file
@@ -1,16 +1,42 @@
 #include "pagerank.h"
 #include "../LogManager.h"
+#include "../Parallel.h"
 #include <vector>
 #include <cmath>
+#include <algorithm>
+#include <numeric>
 #include <unordered_map>
+#include <deque>
 
 using namespace std;
 
+// Below this many CSR entries the thread start-up costs more than it saves
+static const uint64_t PARALLEL_MIN_ARCS = 1 << 16;
+
+// Power-iteration tolerance of full runs, including incremental fallbacks (L1 norm)
+static const double FULL_TOLERANCE = 1e-10;
+
+// Error allowed for the cache's pushed updates: with the push threshold tied to
+// this, a single new friendship costs a few thousand pushes instead of a full pass
+static const double INCREMENTAL_TOLERANCE = 1e-4;
+
 unordered_map<int, double> calculate_pagerank(
     const SocialNetwork& network,
     double dampingFactor,
     int iterations,
-    bool log_results) {
+    bool log_results,
+    double tolerance,
+    PageRankStats* stats) {
+    return calculate_pagerank(*network.snapshot(), dampingFactor, iterations, log_results, tolerance, stats);
+}
+
+unordered_map<int, double> calculate_pagerank(
+    const GraphSnapshot& graph,
+    double dampingFactor,
+    int iterations,
+    bool log_results,
+    double tolerance,
+    PageRankStats* stats) {
 
     // Clear logs and set algorithm info only if logging is enabled
     if (log_results) {
@@ -22,67 +48,332 @@ unordered_map<int, double> calculate_pagerank(
         );
     }
 
-    const auto& allUsers = network.get_all_users();
-    int N = allUsers.size();
+    int N = graph.num_users();
     if (N == 0) {
+        if (stats) *stats = PageRankStats();
         return {}; // Handle empty graph
     }
 
-    // Initialize scores: everyone starts with 1/N
-    unordered_map<int, double> scores;
-    for (int userID : allUsers) {
-        scores[userID] = 1.0 / N;
-    }
+    vector<double> scores = pagerank_dense(graph, dampingFactor, iterations, tolerance, 0, stats);
 
-    // --- Power Iteration Loop ---
-    for (int i = 0; i < iterations; ++i) {
-        unordered_map<int, double> newScores; // Scores for this iteration
-        double total_S_contribution = 0.0; // For handling "sink" nodes (no friends)
-
-        // 1. Calculate contributions from all nodes
-        for (int userID : allUsers) {
-            int degree = network.get_degree(userID);
-            
-            if (degree == 0) {
-                // This is a "sink" node. It contributes its score to everyone.
-                total_S_contribution += scores[userID];
-            } else {
-                // This node gives its score to all its friends
-                double contribution = scores[userID] / degree;
-                for (int friendID : network.get_friends(userID)) {
-                    newScores[friendID] += contribution;
-                }
-            }
-        }
-        
-        // 2. Combine scores with the "damping factor"
-        for (int userID : allUsers) {
-            // (1-d)/N is the "random jump" probability
-            // d * (newScores[userID] + ... ) is the "follow a link" probability
-            newScores[userID] = (1.0 - dampingFactor) / N + dampingFactor * (newScores[userID] + total_S_contribution / N);
-        }
-
-        // 3. Update scores for the next iteration
-        scores = newScores;
+    // --- Translate back to user IDs ---
+    unordered_map<int, double> result;
+    result.reserve(N);
+    for (int v = 0; v < N; ++v) {
+        result[graph.user_id(v)] = scores[v];
     }
     
     // --- Log High PageRank Users (only if logging enabled) ---
     if (log_results) {
         // Find max score for normalization
         double maxScore = 0.0;
-        for (const auto& [user, score] : scores) {
+        for (double score : scores) {
             if (score > maxScore) maxScore = score;
         }
         
         // Log users with high PageRank (top 30%)
         if (maxScore > 0) {
-            for (const auto& [user, score] : scores) {
-                if (score >= maxScore * 0.3) {
-                    LogManager::log("visit", user, -1, score);
+            for (int v = 0; v < N; ++v) {
+                if (scores[v] >= maxScore * 0.3) {
+                    LogManager::log("visit", graph.user_id(v), -1, scores[v]);
                 }
             }
         }
     }
 
+    return result;
+}
+
+vector<double> pagerank_dense(
+    const GraphSnapshot& graph,
+    double dampingFactor,
+    int maxIterations,
+    double tolerance,
+    int threads,
+    PageRankStats* stats,
+    const vector<double>& initial) {
+
+    int N = graph.num_users();
+    PageRankStats run;
+    if (N == 0) {
+        if (stats) *stats = run;
+        return {};
+    }
+
+    const uint64_t* offsets = graph.offsets();
+    int T = offsets[N] < PARALLEL_MIN_ARCS ? 1 : min(resolve_thread_count(threads), N);
+
+    // Split users into T ranges with roughly equal numbers of CSR entries
+    vector<int> bounds(T + 1, N);
+    bounds[0] = 0;
+    for (int t = 1; t < T; ++t) {
+        uint64_t target = offsets[N] * t / T;
+        bounds[t] = max(bounds[t - 1], (int)(lower_bound(offsets, offsets + N + 1, target) - offsets));
+    }
+
+    // Initialize scores: everyone starts with 1/N (unless warm-started)
+    vector<double> scores = initial.size() == (size_t)N ? initial : vector<double>(N, 1.0 / N);
+    vector<double> newScores(N);
+    vector<double> contribution(N); // score / degree, what each user passes to each friend
+    vector<double> partialSink(T), partialResidual(T);
+
+    // --- Power Iteration Loop ---
+    while (run.iterations < maxIterations) {
+        // 1. Each user's per-friend contribution; "sink" users (no friends)
+        //    instead spread their whole score over everyone
+        run_in_parallel(T, [&](int t) {
+            double sink = 0.0;
+            for (int v = bounds[t]; v < bounds[t + 1]; ++v) {
+                int degree = graph.degree(v);
+                if (degree == 0) {
+                    sink += scores[v];
+                    contribution[v] = 0.0;
+                } else {
+                    contribution[v] = scores[v] / degree;
+                }
+            }
+            partialSink[t] = sink;
+        });
+        double total_S_contribution = 0.0;
+        for (double sink : partialSink) total_S_contribution += sink;
+
+        // 2. Pull: every user gathers from its friends, then applies damping
+        //    (1-d)/N is the "random jump" probability
+        //    d * (gathered + sink share) is the "follow a link" probability
+        double base = (1.0 - dampingFactor) / N + dampingFactor * total_S_contribution / N;
+        run_in_parallel(T, [&](int t) {
+            double residual = 0.0;
+            for (int v = bounds[t]; v < bounds[t + 1]; ++v) {
+                double gathered = 0.0;
+                for (int w : graph.neighbors_of(v)) {
+                    gathered += contribution[w];
+                }
+                newScores[v] = base + dampingFactor * gathered;
+                residual += fabs(newScores[v] - scores[v]);
+            }
+            partialResidual[t] = residual;
+        });
+
+        // 3. Update scores for the next iteration
+        scores.swap(newScores);
+        run.iterations++;
+        run.residual = 0.0;
+        for (double residual : partialResidual) run.residual += residual;
+        if (run.residual < tolerance) {
+            run.converged = true;
+            break;
+        }
+    }
+
+    if (stats) *stats = run;
     return scores;
+}
+
+vector<double> pagerank_incremental(
+    const GraphSnapshot& newGraph,
+    const GraphSnapshot& oldGraph,
+    const vector<double>& previous,
+    const vector<pair<int, int>>& changedEdges,
+    double dampingFactor,
+    double tolerance,
+    PageRankStats* stats,
+    vector<double>* leftover) {
+
+    int N = newGraph.num_users();
+    PageRankStats run;
+    run.incremental = true;
+    bool carried = leftover && leftover->size() == previous.size();
+
+    // Warm start: carry the old scores over by user ID and run the full engine
+    auto full_refresh = [&](const char* reason) {
+        vector<double> start(N, 0.0);
+        double total = 0.0;
+        for (int v = 0; v < N; ++v) {
+            int old = oldGraph.index_of(newGraph.user_id(v));
+            start[v] = old >= 0 ? previous[old] : 1.0 / N;
+            total += start[v];
+        }
+        for (double& score : start) score /= total; // keep it a probability vector
+        vector<double> scores = pagerank_dense(newGraph, dampingFactor, 100, FULL_TOLERANCE, 0, stats, start);
+        if (stats) stats->fallback = reason;
+        if (leftover) leftover->clear();
+        return scores;
+    };
+
+    // --- 1. Only purely local changes can be pushed ---
+    bool sameUsers = N == oldGraph.num_users() && (size_t)oldGraph.num_users() == previous.size();
+    for (int v = 0; sameUsers && v < N; ++v) {
+        sameUsers = newGraph.user_id(v) == oldGraph.user_id(v);
+    }
+    if (!sameUsers || N == 0) return full_refresh("the user set changed");
+
+    vector<int> endpoints;
+    for (const auto& [userA, userB] : changedEdges) {
+        for (int userID : {userA, userB}) {
+            int v = newGraph.index_of(userID);
+            if (v < 0) return full_refresh("the user set changed");
+            // A user becoming (or ceasing to be) a sink changes everyone's share
+            if ((newGraph.degree(v) == 0) != (oldGraph.degree(v) == 0)) {
+                return full_refresh("a user gained or lost their last friend");
+            }
+            endpoints.push_back(v);
+        }
+    }
+
+    // --- 2. Residual r = c + d * sum(x[w] / deg(w)) - x, around the change only ---
+    // (c is the random-jump plus sink share, unchanged because the sinks are)
+    vector<double> scores = previous;
+    double sinkMass = 0.0;
+    for (int v = 0; v < N; ++v) {
+        if (newGraph.degree(v) == 0) sinkMass += scores[v];
+    }
+    double base = (1.0 - dampingFactor) / N + dampingFactor * sinkMass / N;
+
+    // Residual left over from the previous update (zero after a full run)
+    vector<double> residual = carried ? *leftover : vector<double>(N, 0.0);
+    vector<char> queued(N, 0);
+    deque<int> work;
+    auto exact_residual = [&](int v) {
+        double gathered = 0.0;
+        for (int w : newGraph.neighbors_of(v)) {
+            gathered += scores[w] / newGraph.degree(w);
+        }
+        return base + dampingFactor * gathered - scores[v];
+    };
+    // Affected: the endpoints (their friend lists changed) and every friend of
+    // an endpoint (an endpoint's degree, and so its contribution, changed)
+    for (int u : endpoints) {
+        for (int v : newGraph.neighbors_of(u)) {
+            if (!queued[v]) { queued[v] = 1; work.push_back(v); }
+        }
+        if (!queued[u]) { queued[u] = 1; work.push_back(u); }
+    }
+    for (int v : work) {
+        residual[v] = exact_residual(v);
+    }
+
+    // --- 3. Push until every residual is below epsilon * degree ---
+    // (the Andersen-Chung-Lang rule: a push costs deg(u), so only residuals
+    // that are large for their degree are worth spreading). The scores are
+    // off by at most |r|_1 / (1 - d) <= epsilon * (2E + N) / (1 - d), so this
+    // epsilon keeps the error within 'tolerance'
+    double epsilon = tolerance * (1.0 - dampingFactor) / ((double)newGraph.offsets()[N] + N);
+    auto threshold = [&](int v) { return epsilon * max(newGraph.degree(v), 1); };
+    // Safety net for a loose epsilon on a huge change: past the cost of two
+    // full iterations, hand the partly updated scores to the power iteration
+    long long budget = 2 * ((long long)newGraph.offsets()[N] + N);
+    long long work_done = 0;
+    while (!work.empty()) {
+        int u = work.front();
+        work.pop_front();
+        queued[u] = 0;
+
+        double r = residual[u];
+        if (fabs(r) <= threshold(u)) continue;
+
+        scores[u] += r;
+        residual[u] = 0.0;
+        run.pushes++;
+
+        int degree = newGraph.degree(u);
+        work_done += degree + 1;
+        if (work_done > budget) {
+            vector<double> refreshed = pagerank_dense(newGraph, dampingFactor, 100, FULL_TOLERANCE, 0, stats, scores);
+            if (stats) stats->fallback = "the pushes cost more than two full iterations";
+            if (leftover) leftover->clear();
+            return refreshed;
+        }
+
+        if (degree == 0) continue; // an unchanged sink: nothing to pass on
+        double share = dampingFactor * r / degree;
+        for (int w : newGraph.neighbors_of(u)) {
+            residual[w] += share;
+            if (!queued[w] && fabs(residual[w]) > threshold(w)) {
+                queued[w] = 1;
+                work.push_back(w);
+            }
+        }
+    }
+
+    for (double r : residual) run.residual += fabs(r);
+    run.converged = run.residual <= tolerance * (1.0 - dampingFactor);
+    if (stats) *stats = run;
+    if (leftover) leftover->swap(residual);
+    return scores;
+}
+
+shared_ptr<const PageRankResult> PageRankCache::get(const SocialNetwork& network) {
+    lock_guard<mutex> guard(lock);
+    if (current && current->version == network.get_version()) {
+        hitCount++;
+        return current;
+    }
+    missCount++;
+
+    auto result = make_shared<PageRankResult>();
+    result->version = network.get_version();
+    result->graph = network.snapshot();
+
+    // Friendship-only changes since the cached version: update it in place
+    vector<GraphChange> changes;
+    vector<pair<int, int>> changedEdges;
+    bool incremental = current && network.changes_since(current->version, changes);
+    for (const GraphChange& change : changes) {
+        if (change.kind == GraphChange::ADD_USER) incremental = false;
+        changedEdges.push_back({change.userA, change.userB});
+    }
+
+    if (incremental) {
+        result->leftover = current->leftover;
+        result->dense = pagerank_incremental(*result->graph, *current->graph, current->dense,
+                                             changedEdges, 0.85, INCREMENTAL_TOLERANCE,
+                                             &result->stats, &result->leftover);
+    } else {
+        result->dense = pagerank_dense(*result->graph, 0.85, 100, FULL_TOLERANCE, 0, &result->stats);
+    }
+
+    current = result;
+    return current;
+}
+
+const unordered_map<int, double>& PageRankResult::by_user() const {
+    call_once(byUserBuilt, [this]() {
+        int N = graph->num_users();
+        byUser.reserve(N);
+        for (int v = 0; v < N; ++v) {
+            byUser[graph->user_id(v)] = dense[v];
+        }
+    });
+    return byUser;
+}
+
+const vector<int>& PageRankResult::ranked() const {
+    // Score order, for consumers that walk users from the most important down
+    call_once(rankedBuilt, [this]() {
+        rankedOrder.resize(dense.size());
+        iota(rankedOrder.begin(), rankedOrder.end(), 0);
+        sort(rankedOrder.begin(), rankedOrder.end(),
+             [this](int a, int b) { return dense[a] > dense[b] || (dense[a] == dense[b] && a > b); });
+    });
+    return rankedOrder;
+}
+
+size_t PageRankCache::hits() const {
+    lock_guard<mutex> guard(lock);
+    return hitCount;
+}
+
+size_t PageRankCache::misses() const {
+    lock_guard<mutex> guard(lock);
+    return missCount;
+}
+
+void PageRankCache::clear() {
+    lock_guard<mutex> guard(lock);
+    current.reset();
+}
+
+PageRankCache& PageRankCache::shared() {
+    static PageRankCache instance;
+    return instance;
 }
\ No newline at end of file
@@ -1,18 +1,154 @@
 #pragma once
 
 #include "../SocialNetwork.h"
+#include "../GraphSnapshot.h"
 #include <unordered_map>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+
+
+//Convergence report for one PageRank run.
+struct PageRankStats {
+    int iterations = 0;      // power iterations actually run
+    double residual = 0.0;   // L1 norm of the change made by the last iteration
+    bool converged = false;  // true if residual fell below the tolerance
+                             // (incremental runs: the leftover push residual, see pagerank_incremental)
+    bool incremental = false; // true if produced by pagerank_incremental's push updates
+    long long pushes = 0;    // push operations (incremental runs only)
+    const char* fallback = nullptr; // why pagerank_incremental ran the power iteration instead
+};
 
 
 //Calculates the PageRank score for all nodes in the graph.
 //network The populated SocialNetwork object.
 //dampingFactor (d) How much to trust the random walk. (0.85 is standard).
-//iterations The number of iterations to run. (More is more accurate).
+//iterations The maximum number of iterations to run. (More is more accurate).
+//tolerance Stop early once an iteration changes the scores by less than this (L1 norm).
+//stats If non-null, receives the iterations run and the final residual.
 //Return an std::unordered_map<int, double> mapping UserID to PageRank score.
  
 std::unordered_map<int, double> calculate_pagerank(
     const SocialNetwork& network,
     double dampingFactor = 0.85,
     int iterations = 100,
-    bool log_results = true
-);
\ No newline at end of file
+    bool log_results = true,
+    double tolerance = 1e-10,
+    PageRankStats* stats = nullptr
+);
+
+
+//Same as above, but runs directly on a frozen CSR snapshot of the network.
+ 
+std::unordered_map<int, double> calculate_pagerank(
+    const GraphSnapshot& graph,
+    double dampingFactor = 0.85,
+    int iterations = 100,
+    bool log_results = true,
+    double tolerance = 1e-10,
+    PageRankStats* stats = nullptr
+);
+
+
+//The PageRank engine behind calculate_pagerank, on contiguous arrays.
+//Uses the "pull" formulation: every user sums the contributions of its own
+//friends, so users can be split across threads with no atomics or locks.
+//graph The CSR snapshot.
+//threads Worker threads (0 = auto; small graphs always run on one thread).
+//initial Optional warm start indexed by dense index (empty = uniform 1/N).
+//Returns scores indexed by dense snapshot index.
+ 
+std::vector<double> pagerank_dense(
+    const GraphSnapshot& graph,
+    double dampingFactor,
+    int maxIterations,
+    double tolerance,
+    int threads = 0,
+    PageRankStats* stats = nullptr,
+    const std::vector<double>& initial = {}
+);
+
+
+
+//Brings an earlier PageRank vector up to date after a batch of friendship changes.
+//Instead of re-running the power iteration over the whole graph, it computes
+//the residual only around the changed edges and pushes it outward (local
+//"push" updates, Andersen-Chung-Lang style) until every user's residual is
+//below epsilon * degree, with epsilon chosen so the scores end up within
+//'tolerance' (L1 norm) of the exact PageRank.
+//Falls back to a warm-started pagerank_dense (stats->fallback says why) when
+//the change is not local: the user set changed, a user gained or lost their
+//last friend (the sink share is global), or the pushes stop being cheaper
+//than a full pass.
+//newGraph The graph after the changes.
+//oldGraph The graph 'previous' was computed on.
+//previous Scores indexed by oldGraph's dense indices.
+//changedEdges The added or removed friendships, as (userA, userB) user IDs.
+//tolerance Error allowed for the pushed scores (looser than a full run's 1e-10).
+//leftover If non-null: in, the residual 'previous' was left with (empty = none);
+//out, the residual left by this update (empty after a fallback). Carrying it
+//forward keeps the error within 'tolerance' over any number of updates.
+//Returns scores indexed by newGraph's dense indices.
+ 
+std::vector<double> pagerank_incremental(
+    const GraphSnapshot& newGraph,
+    const GraphSnapshot& oldGraph,
+    const std::vector<double>& previous,
+    const std::vector<std::pair<int, int>>& changedEdges,
+    double dampingFactor = 0.85,
+    double tolerance = 1e-4,
+    PageRankStats* stats = nullptr,
+    std::vector<double>* leftover = nullptr
+);
+
+
+//One cached PageRank result: scores by dense index, plus lookup views that are
+//built on first use (most misses are followed by queries that need neither).
+struct PageRankResult {
+    std::shared_ptr<const GraphSnapshot> graph;  // the snapshot the scores were computed on
+    std::vector<double> dense;                    // indexed by graph->index_of(userID)
+    PageRankStats stats;
+    std::vector<double> leftover;                 // pagerank_incremental's residual (empty after a full run)
+    uint64_t version = 0;                         // SocialNetwork::get_version() it belongs to
+
+    //UserID -> PageRank score (O(N) the first time it is asked for).
+    const std::unordered_map<int, double>& by_user() const;
+
+    //Dense indices, highest score first (O(N log N) the first time it is asked for).
+    const std::vector<int>& ranked() const;
+
+private:
+    mutable std::once_flag byUserBuilt, rankedBuilt;
+    mutable std::unordered_map<int, double> byUser;
+    mutable std::vector<int> rankedOrder;
+};
+
+
+//Shared cache of the global PageRank (d = 0.85, up to 100 iterations).
+//Keyed by SocialNetwork::get_version(): as long as the graph has not changed,
+//recommenders and the exporter reuse one result instead of re-running PageRank.
+//After friendship changes the cached result is updated with
+//pagerank_incremental when the network's change history allows it, so it is
+//then exact to 1e-4 (L1 norm) rather than 1e-10.
+//Thread-safe; results are immutable and stay valid after later mutations.
+class PageRankCache {
+public:
+    //Gets the PageRank for the network's current version, computing it on a miss.
+    std::shared_ptr<const PageRankResult> get(const SocialNetwork& network);
+
+    size_t hits() const;
+    size_t misses() const;
+
+    //Drops the cached result (counters are kept).
+    void clear();
+
+    //The process-wide instance used by influence, hybrid and WebExporter.
+    static PageRankCache& shared();
+
+private:
+    mutable std::mutex lock;
+    std::shared_ptr<const PageRankResult> current;
+    size_t hitCount = 0;
+    size_t missCount = 0;
+};
\ No newline at end of file
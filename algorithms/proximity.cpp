@@ -1,15 +1,18 @@
 #include "proximity.h"
+#include "workspace.h"
+#include "../GraphSnapshot.h"
 #include "../LogManager.h" 
-#include <unordered_map>
-#include <queue>
-#include <utility>
 #include <cmath> 
 
 using namespace std;
 
-using ScorePair = pair<double, int>;
-
 vector<int> recommend_by_proximity(const SocialNetwork& network, int userID, int top_k) {
+    vector<int> recommendations;
+    recommend_by_proximity(network, userID, top_k, recommendations);
+    return recommendations;
+}
+
+void recommend_by_proximity(const SocialNetwork& network, int userID, int top_k, vector<int>& out) {
     // 1. CLEAR previous logs and set algorithm info
     LogManager::clear();
     LogManager::setAlgorithm(
@@ -18,48 +21,47 @@ vector<int> recommend_by_proximity(const SocialNetwork& network, int userID, int
         userID
     );
     LogManager::log("source", userID); // Special log for the starting user
+    out.clear();
 
-    unordered_map<int, double> adamicAdarScores;
-    const auto& myFriends = network.get_friends(userID);
+    // Dense scores in this thread's reusable workspace (no per-query tables)
+    auto graphPtr = network.snapshot();
+    const GraphSnapshot& graph = *graphPtr;
+    QueryWorkspace& ws = QueryWorkspace::local();
+    if (start_recommendation_query(network, graph, userID, ws) == -1) return;
 
     // --- Core Algorithm ---
-    for (int friendID : myFriends) {
-        // LOG: We are looking at a direct friend (The "Bridge")
-        LogManager::log("visit", friendID, userID); 
-
-        for (int fofID : network.get_friends(friendID)) {
-            if (fofID == userID) continue;
-            if (myFriends.count(fofID)) continue;
+    score_proximity(graph, 1.0, ws);
 
+    // --- Replay the walk for the dashboard ---
+    for (int f : ws.order()) {
+        // LOG: We are looking at a direct friend (The "Bridge")
+        int friendID = graph.user_id(f);
+        LogManager::log("visit", friendID, userID);
+        for (int fof : graph.neighbors_of(f)) {
             // LOG: We found a "Friend of a Friend" (A Candidate)
-            LogManager::log("scan", fofID, friendID);
-
-            int commonFriendDegree = network.get_degree(friendID);
-            if (commonFriendDegree > 1) {
-                adamicAdarScores[fofID] += 1.0 / log(commonFriendDegree);
-            }
+            if (!ws.is_excluded(fof)) LogManager::log("scan", graph.user_id(fof), friendID);
         }
     }
 
-    // --- Get Top K Results ---
-    priority_queue<ScorePair> pq;
-    for (auto const& [candidateID, score] : adamicAdarScores) {
-        pq.push({score, candidateID});
-    }
-
-    vector<int> recommendations;
-    while (!pq.empty() && recommendations.size() < static_cast<size_t>(top_k)) {
-        // DEFINE 'rec' HERE so we can use it for logging
-        int rec = pq.top().second;
-        double score = pq.top().first;
-        
-        recommendations.push_back(rec);
+    // --- Get Top K Results (bounded heap) ---
+    for (const auto& [score, index] : ws.top_k(top_k)) {
+        int rec = graph.user_id(index);
+        out.push_back(rec);
         
         // LOG: This is a final recommendation with score!
         LogManager::log("match", rec, -1, score); 
-        
-        pq.pop();
     }
+}
 
-    return recommendations;
+void score_proximity(const GraphSnapshot& graph, double weight, QueryWorkspace& ws) {
+    for (int f : ws.order()) {
+        // A friend with no other friends links us to nobody (and log(1) = 0)
+        int commonFriendDegree = graph.degree(f);
+        if (commonFriendDegree <= 1) continue;
+        double contribution = weight * (1.0 / log(commonFriendDegree));
+        for (int fof : graph.neighbors_of(f)) {
+            if (ws.is_excluded(fof)) continue;
+            ws.add(fof, contribution);
+        }
+    }
 }
\ No newline at end of file
@@ -1,8 +1,11 @@
 #pragma once
 // using namespace std;
 #include "../SocialNetwork.h"
+#include "../GraphSnapshot.h"
 #include <vector>
 
+class QueryWorkspace;
+
 
 //Recommends users based on proximity (common friends count).
 //network The populated SocialNetwork object.
@@ -10,4 +13,18 @@
 //top_k The number of recommendations to return.
 //Returns a vector of recommended user IDs, sorted by score.
  
-vector<int> recommend_by_proximity(const SocialNetwork& network, int userID, int top_k);
\ No newline at end of file
+vector<int> recommend_by_proximity(const SocialNetwork& network, int userID, int top_k);
+
+
+//Same as above, but writes into 'out' (cleared first) so a caller that reuses
+//it makes no allocations once its capacity has grown (see QueryWorkspace).
+ 
+void recommend_by_proximity(const SocialNetwork& network, int userID, int top_k, vector<int>& out);
+
+
+//Logging-free core of recommend_by_proximity, shared with the hybrid and batch
+//recommenders: adds weight * Adamic-Adar to every friend-of-friend of the user
+//whose query ws holds (see start_recommendation_query), walking the friends
+//in ws.order().
+ 
+void score_proximity(const GraphSnapshot& graph, double weight, QueryWorkspace& ws);
\ No newline at end of file
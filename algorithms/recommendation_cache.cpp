@@ -0,0 +1,166 @@
+#include "recommendation_cache.h"
+#include "influence.h"
+#include "proximity.h"
+#include "hybrid.h"
+#include <unordered_set>
+#include <functional>
+
+using namespace std;
+
+size_t RecommendationCache::KeyHash::operator()(const Key& key) const {
+    size_t hash = std::hash<int>()(key.userID);
+    hash = hash * 31 + static_cast<size_t>(key.algorithm);
+    hash = hash * 31 + std::hash<int>()(key.top_k);
+    hash = hash * 31 + std::hash<double>()(key.w_influence);
+    hash = hash * 31 + std::hash<double>()(key.w_proximity);
+    return hash;
+}
+
+RecommendationCache::RecommendationCache(size_t capacity) : capacity(capacity > 0 ? capacity : 1) {}
+
+vector<int> RecommendationCache::recommend(const SocialNetwork& network, int userID, RecommendAlgorithm algorithm,
+                                           int top_k, double w_influence, double w_proximity) {
+    lock_guard<mutex> guard(lock);
+    catch_up(network);
+
+    // Weights only matter to the hybrid recommender
+    if (algorithm != RecommendAlgorithm::HYBRID) {
+        w_influence = w_proximity = 0.0;
+    }
+    Key key = {userID, algorithm, top_k, w_influence, w_proximity};
+
+    // --- 1. Hit: move to the front and replay the dashboard log ---
+    auto found = index.find(key);
+    if (found != index.end()) {
+        hitCount++;
+        entries.splice(entries.begin(), entries, found->second);
+        const Entry& entry = entries.front();
+        LogManager::setAlgorithm(entry.algorithmName, entry.algorithmDescription, userID);
+        LogManager::events = entry.events;
+        return entry.recommendations;
+    }
+
+    // --- 2. Miss: run the recommender and remember its answer ---
+    missCount++;
+    Entry entry;
+    entry.key = key;
+    if (algorithm == RecommendAlgorithm::INFLUENCE) {
+        entry.recommendations = recommend_by_influence(network, userID, top_k);
+    } else if (algorithm == RecommendAlgorithm::PROXIMITY) {
+        entry.recommendations = recommend_by_proximity(network, userID, top_k);
+    } else {
+        entry.recommendations = recommend_by_hybrid(network, userID, top_k, w_influence, w_proximity);
+    }
+    entry.algorithmName = LogManager::algorithmName;
+    entry.algorithmDescription = LogManager::algorithmDescription;
+    entry.events = LogManager::events;
+
+    entries.push_front(std::move(entry));
+    index[key] = entries.begin();
+    if (entries.size() > capacity) {
+        erase(prev(entries.end()));
+        evictionCount++;
+    }
+    return entries.front().recommendations;
+}
+
+void RecommendationCache::catch_up(const SocialNetwork& network) {
+    uint64_t current = network.get_version();
+    if (synced && version == current) return;
+
+    vector<GraphChange> changes;
+    if (!synced || !network.changes_since(version, changes)) {
+        // First use, or too much has changed to tell what is affected
+        invalidationCount += entries.size();
+        entries.clear();
+        index.clear();
+        version = current;
+        synced = true;
+        return;
+    }
+
+    // --- 1. What the changes can reach ---
+    // 'near' holds the changed friendships' endpoints and their friends: a user
+    // is within 2 hops of an endpoint iff it, or one of its friends, is in 'near'.
+    bool dropInfluence = false;
+    unordered_set<int> near;
+    for (const GraphChange& change : changes) {
+        dropInfluence = true; // new tags or a new PageRank
+        if (change.kind == GraphChange::ADD_USER) continue;
+        for (int endpoint : {change.userA, change.userB}) {
+            near.insert(endpoint);
+            for (int friendID : network.get_friends(endpoint)) {
+                near.insert(friendID);
+            }
+        }
+    }
+
+    // --- 2. Drop exactly the affected entries ---
+    for (auto it = entries.begin(); it != entries.end();) {
+        auto nextIt = next(it);
+        bool affected = false;
+        if (it->key.algorithm != RecommendAlgorithm::PROXIMITY) {
+            affected = dropInfluence;
+        } else if (!near.empty()) {
+            int userID = it->key.userID;
+            affected = near.count(userID) > 0;
+            for (int friendID : network.get_friends(userID)) {
+                if (affected) break;
+                affected = near.count(friendID) > 0;
+            }
+        }
+        if (affected) {
+            erase(it);
+            invalidationCount++;
+        }
+        it = nextIt;
+    }
+    version = current;
+}
+
+void RecommendationCache::erase(EntryList::iterator it) {
+    index.erase(it->key);
+    entries.erase(it);
+}
+
+size_t RecommendationCache::hits() const {
+    lock_guard<mutex> guard(lock);
+    return hitCount;
+}
+
+size_t RecommendationCache::misses() const {
+    lock_guard<mutex> guard(lock);
+    return missCount;
+}
+
+size_t RecommendationCache::evictions() const {
+    lock_guard<mutex> guard(lock);
+    return evictionCount;
+}
+
+size_t RecommendationCache::invalidations() const {
+    lock_guard<mutex> guard(lock);
+    return invalidationCount;
+}
+
+double RecommendationCache::hit_rate() const {
+    lock_guard<mutex> guard(lock);
+    size_t lookups = hitCount + missCount;
+    return lookups > 0 ? static_cast<double>(hitCount) / lookups : 0.0;
+}
+
+size_t RecommendationCache::size() const {
+    lock_guard<mutex> guard(lock);
+    return entries.size();
+}
+
+void RecommendationCache::clear() {
+    lock_guard<mutex> guard(lock);
+    entries.clear();
+    index.clear();
+}
+
+RecommendationCache& RecommendationCache::shared() {
+    static RecommendationCache instance;
+    return instance;
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+#pragma once
+
+using namespace std;
+#include "../SocialNetwork.h"
+#include "../LogManager.h"
+#include "batch.h"
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <string>
+#include <cstdint>
+
+
+//Bounded (LRU) cache in front of the three recommenders.
+//Entries are keyed by (user, algorithm, k, weights) and invalidated from the
+//network's change history (SocialNetwork::changes_since), touching only what
+//a change can affect:
+//  - A friendship added or removed between a and b evicts the proximity
+//    entries of users within 2 hops of a or b (Adamic-Adar only looks at
+//    friends and friends-of-friends).
+//  - Influence and hybrid entries depend on PageRank, which any friendship
+//    change moves for everyone, so friendship changes evict all of them.
+//  - A new user (with tags) evicts influence and hybrid entries only: they
+//    scan every user's tags, while the new user has no friends yet.
+//If the history no longer reaches back far enough, everything is dropped.
+//Thread-safe.
+class RecommendationCache {
+public:
+    explicit RecommendationCache(size_t capacity = 1024);
+
+    //Same result as recommend_by_influence / _proximity / _hybrid, served from
+    //the cache when the entry is still valid. On a hit, the dashboard log is
+    //refilled with the recommender's full trace, exactly as the miss logged it.
+    vector<int> recommend(const SocialNetwork& network, int userID, RecommendAlgorithm algorithm, int top_k,
+                          double w_influence = 0.5, double w_proximity = 0.5);
+
+    size_t hits() const;
+    size_t misses() const;
+    size_t evictions() const;      // entries pushed out by the size limit
+    size_t invalidations() const;  // entries dropped because the graph changed
+    double hit_rate() const;
+    size_t size() const;
+
+    //Drops every entry (counters are kept).
+    void clear();
+
+    //The process-wide instance used by the menu.
+    static RecommendationCache& shared();
+
+private:
+    struct Key {
+        int userID;
+        RecommendAlgorithm algorithm;
+        int top_k;
+        double w_influence;
+        double w_proximity;
+        bool operator==(const Key& other) const {
+            return userID == other.userID && algorithm == other.algorithm && top_k == other.top_k &&
+                   w_influence == other.w_influence && w_proximity == other.w_proximity;
+        }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+    struct Entry {
+        Key key;
+        vector<int> recommendations;
+        string algorithmName;        // dashboard metadata and trace, replayed on hits
+        string algorithmDescription;
+        vector<LogEvent> events;
+    };
+    using EntryList = list<Entry>;
+
+    //Applies the invalidation rules for every change since 'version'.
+    void catch_up(const SocialNetwork& network);
+    void erase(EntryList::iterator it);
+
+    mutable mutex lock;
+    size_t capacity;
+    EntryList entries; // most recently used first
+    unordered_map<Key, EntryList::iterator, KeyHash> index;
+    uint64_t version = 0;
+    bool synced = false;
+    size_t hitCount = 0;
+    size_t missCount = 0;
+    size_t evictionCount = 0;
+    size_t invalidationCount = 0;
+};
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include <unordered_set>
 #include <string>
+#include <vector>
+#include <cstdint>
 
 
 //Calculates Jaccard Similarity between two sets of strings.
@@ -27,4 +29,32 @@ inline double jaccard_similarity(const unordered_set<string>& setA, const unorde
     if (unionSize == 0) return 0.0; // Avoid division by zero if one set is empty
 
     return static_cast<double>(intersection) / unionSize;
+}
+
+
+//Jaccard Index from the set sizes and their intersection size.
+//Matches the string version above: two empty sets count as identical.
+ 
+inline double jaccard_from_counts(size_t sizeA, size_t sizeB, size_t intersection) {
+    if (sizeA == 0 && sizeB == 0) return 1.0; // Two empty sets are identical
+
+    size_t unionSize = sizeA + sizeB - intersection;
+    if (unionSize == 0) return 0.0;
+
+    return static_cast<double>(intersection) / unionSize;
+}
+
+
+//Calculates Jaccard Similarity between two sorted arrays of interned tag IDs.
+//(See SocialNetwork::get_tag_ids.) A branch-light merge: no string hashing.
+ 
+inline double jaccard_similarity(const vector<int>& idsA, const vector<int>& idsB) {
+    size_t i = 0, j = 0, intersection = 0;
+    while (i < idsA.size() && j < idsB.size()) {
+        int a = idsA[i], b = idsB[j];
+        intersection += (a == b);
+        i += (a <= b);
+        j += (b <= a);
+    }
+    return jaccard_from_counts(idsA.size(), idsB.size(), intersection);
 }
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include "workspace.h"
+#include "../SocialNetwork.h"
+#include "../GraphSnapshot.h"
+#include <algorithm>
+#include <functional>
+#include <climits>
+
+using namespace std;
+
+void QueryWorkspace::begin(int numUsers) {
+    if (static_cast<int>(scores.size()) < numUsers) {
+        scores.resize(numUsers, 0.0);
+        scored.resize(numUsers, -1);
+        excluded.resize(numUsers, -1);
+        counts.resize(numUsers, 0);
+        countStamp.resize(numUsers, -1);
+    }
+    if (stamp == INT_MAX) {
+        // Stamp wrapped around: old marks could collide with new ones
+        fill(scored.begin(), scored.end(), -1);
+        fill(excluded.begin(), excluded.end(), -1);
+        fill(countStamp.begin(), countStamp.end(), -1);
+        stamp = 0;
+    }
+    stamp++;
+    touchedList.clear();
+    countedList.clear();
+    orderList.clear();
+    pairList.clear();
+}
+
+const vector<pair<double, int>>& QueryWorkspace::top_k(int k) {
+    start_selection(k);
+    for (int index : touchedList) {
+        offer(scores[index], index);
+    }
+    return selection();
+}
+
+void QueryWorkspace::start_selection(int k) {
+    heap.clear();
+    selectionK = max(k, 0);
+}
+
+void QueryWorkspace::offer(double score, int index) {
+    // Min-heap of the best k so far: front() is the one to beat
+    greater<pair<double, int>> worse;
+    pair<double, int> item = {score, index};
+    if (static_cast<int>(heap.size()) < selectionK) {
+        heap.push_back(item);
+        push_heap(heap.begin(), heap.end(), worse);
+    } else if (selectionK > 0 && item > heap.front()) {
+        pop_heap(heap.begin(), heap.end(), worse);
+        heap.back() = item;
+        push_heap(heap.begin(), heap.end(), worse);
+    }
+}
+
+const vector<pair<double, int>>& QueryWorkspace::selection() {
+    sort_heap(heap.begin(), heap.end(), greater<pair<double, int>>()); // best first
+    return heap;
+}
+
+QueryWorkspace& QueryWorkspace::local() {
+    thread_local QueryWorkspace workspace;
+    return workspace;
+}
+
+int start_recommendation_query(const SocialNetwork& network, const GraphSnapshot& graph, int userID,
+                               QueryWorkspace& ws) {
+    int u = graph.index_of(userID);
+    if (u == -1) return -1;
+    ws.begin(graph.num_users());
+    ws.exclude(u);
+    for (int friendID : network.get_friends(userID)) {
+        int f = graph.index_of(friendID);
+        ws.exclude(f);
+        ws.order().push_back(f);
+    }
+    return u;
+}
\ No newline at end of file
@@ -0,0 +1,98 @@
+#pragma once
+
+using namespace std;
+#include <vector>
+#include <utility>
+
+class SocialNetwork;
+class GraphSnapshot;
+
+
+//Reusable scratch space for one recommendation query, indexed by dense
+//snapshot index. Nothing is ever freed or refilled between queries: arrays
+//are "cleared" by bumping a stamp, and the touched lists remember which
+//entries the current query wrote. After the first few queries have grown the
+//buffers, a query allocates nothing.
+//One per thread (see local()); not thread-safe itself.
+class QueryWorkspace {
+public:
+    //Starts a query on a graph of numUsers users: forgets the previous query
+    //and grows the arrays if the graph has grown.
+    void begin(int numUsers);
+
+    //Excludes a candidate (the query user's friends, or the user themselves).
+    void exclude(int index) { excluded[index] = stamp; }
+    bool is_excluded(int index) const { return excluded[index] == stamp; }
+
+    //Adds to a candidate's score; the first add records it in touched().
+    void add(int index, double value) {
+        if (scored[index] != stamp) {
+            scored[index] = stamp;
+            scores[index] = 0.0;
+            touchedList.push_back(index);
+        }
+        scores[index] += value;
+    }
+    double score(int index) const { return scores[index]; }
+    bool is_scored(int index) const { return scored[index] == stamp; }
+    const vector<int>& touched() const { return touchedList; }
+
+    //Per-candidate counter (e.g. shared tags); the first increment records it in counted().
+    void increment(int index) {
+        if (countStamp[index] != stamp) {
+            countStamp[index] = stamp;
+            counts[index] = 0;
+            countedList.push_back(index);
+        }
+        counts[index]++;
+    }
+    int count(int index) const { return counts[index]; }
+    const vector<int>& counted() const { return countedList; }
+
+    //Scratch list for an ordered walk (e.g. the query user's friends in get_friends order).
+    vector<int>& order() { return orderList; }
+
+    //Scratch list of (score, index) pairs, e.g. a candidate stream to sort.
+    vector<pair<double, int>>& pairs() { return pairList; }
+
+    //The k highest-scoring touched candidates as (score, index), best first.
+    //Ties go to the higher index, i.e. the higher user ID, as with a
+    //priority_queue of (score, userID). Selected with a bounded size-k heap.
+    const vector<pair<double, int>>& top_k(int k);
+
+    //The same bounded heap, fed one candidate at a time:
+    //start_selection(k), then offer() each candidate, then selection().
+    void start_selection(int k);
+    void offer(double score, int index);
+    //True once k candidates are held; kth() is then the one to beat.
+    bool selection_full() const { return selectionK > 0 && static_cast<int>(heap.size()) == selectionK; }
+    const pair<double, int>& kth() const { return heap.front(); }
+    //Sorts and returns the held candidates, best first (ends the selection).
+    const vector<pair<double, int>>& selection();
+
+    //The calling thread's workspace.
+    static QueryWorkspace& local();
+
+private:
+    vector<double> scores;  // valid where scored[index] == stamp
+    vector<int> scored;
+    vector<int> excluded;   // == stamp for excluded candidates
+    vector<int> counts;     // valid where countStamp[index] == stamp
+    vector<int> countStamp;
+    vector<int> touchedList;
+    vector<int> countedList;
+    vector<int> orderList;
+    vector<pair<double, int>> pairList;
+    vector<pair<double, int>> heap;
+    int selectionK = 0;
+    int stamp = 0;
+};
+
+
+//Starts a recommendation query for userID in ws: excludes the user and their
+//friends, and lists the friends in ws.order() in get_friends() order, so every
+//score is summed in the same order as always.
+//Returns userID's dense index in 'graph', or -1 (ws untouched) if it has none.
+ 
+int start_recommendation_query(const SocialNetwork& network, const GraphSnapshot& graph, int userID,
+                               QueryWorkspace& ws);
\ No newline at end of file
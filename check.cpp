@@ -0,0 +1,705 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <random>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <cmath>
+#include <sstream>
+#include "SocialNetwork.h"
+#include "GraphSnapshot.h"
+#include "GraphStore.h"
+#include "algorithms/closeness.h"
+#include "algorithms/betweenness.h"
+#include "algorithms/bfs.h"
+#include "algorithms/dobfs.h"
+#include "algorithms/landmarks.h"
+#include "algorithms/influence.h"
+#include "algorithms/proximity.h"
+#include "algorithms/hybrid.h"
+#include "algorithms/pagerank.h"
+#include "algorithms/intersect.h"
+#include "algorithms/neighborhood.h"
+
+using namespace std;
+
+// Consistency checks for the optimized graph kernels: each one is compared with
+// a plain reference implementation on the bundled data and on a generated graph
+// with several components and isolated users.
+// Usage: ./recommender_check [edgeFile tagFile]   (built by 'make check')
+
+// --- Allocation counter (read by check_allocations) ---
+// Replaces the global operator new for this executable only; counting costs
+// one relaxed atomic add. (Not inlined, or GCC pairs the malloc with a delete
+// and warns about a mismatch.)
+static atomic<size_t> allocationCount{0};
+
+__attribute__((noinline)) void* operator new(size_t size) {
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept { free(p); }
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept { free(p); }
+
+
+//Writes a network with a random component, a long path, a star and isolated
+//users as edge/tag files in the temp directory and loads it.
+//randomUsers Size of the random component (the other parts follow its IDs).
+
+void load_disconnected_graph(SocialNetwork& network, int randomUsers = 8000) {
+    mt19937 rng(12345);
+    filesystem::path dir = filesystem::temp_directory_path();
+    string edgeFile = (dir / "check_edges.txt").string();
+    string tagFile = (dir / "check_tags.txt").string();
+    int R = randomUsers;
+    {
+        ofstream edges(edgeFile), tags(tagFile);
+        // Users 0..R-1: random friendships, about 10 each (with the default
+        // size, enough CSR entries for the kernels to use their multi-threaded paths)
+        uniform_int_distribution<int> pickUser(0, R - 1);
+        for (int u = 0; u < R; ++u) {
+            for (int f = 0; f < 5; ++f) {
+                int v = pickUser(rng);
+                if (v != u) edges << u << " " << v << "\n";
+            }
+        }
+        // Users R..R+79: a path, longer than one MS-BFS batch is wide
+        for (int u = R; u < R + 79; ++u) edges << u << " " << u + 1 << "\n";
+        // Users R+80..R+119: a star around R+80
+        for (int u = R + 81; u < R + 120; ++u) edges << R + 80 << " " << u << "\n";
+        // Users R+120..R+139: no friends at all
+        for (int u = 0; u < R + 140; ++u) tags << u << " check\n";
+    }
+    network.load_data_parallel(edgeFile, tagFile);
+    filesystem::remove(edgeFile);
+    filesystem::remove(tagFile);
+}
+
+
+//Hop distances from one plain queue-based BFS (-1 = unreachable).
+
+vector<int> reference_distances(const GraphSnapshot& graph, int source) {
+    vector<int> distance(graph.num_users(), -1);
+    vector<int> bfsQueue;
+    bfsQueue.push_back(source);
+    distance[source] = 0;
+    for (size_t head = 0; head < bfsQueue.size(); ++head) {
+        int current = bfsQueue[head];
+        for (int neighbor : graph.neighbors_of(current)) {
+            if (distance[neighbor] == -1) {
+                distance[neighbor] = distance[current] + 1;
+                bfsQueue.push_back(neighbor);
+            }
+        }
+    }
+    return distance;
+}
+
+
+//Closeness from one plain BFS per user (the implementation MS-BFS replaced).
+
+unordered_map<int, double> reference_closeness(const GraphSnapshot& graph) {
+    int N = graph.num_users();
+    unordered_map<int, double> scores;
+    if (N <= 1) return scores;
+
+    for (int start = 0; start < N; ++start) {
+        long long sum_of_distances = 0;
+        int reachable = 0;
+        for (int hops : reference_distances(graph, start)) {
+            if (hops > 0) {
+                sum_of_distances += hops;
+                reachable++;
+            }
+        }
+        double score = 0.0;
+        if (sum_of_distances > 0 && reachable > 0) {
+            score = ((double)reachable / sum_of_distances) * ((double)reachable / (N - 1));
+        }
+        scores[graph.user_id(start)] = score;
+    }
+    return scores;
+}
+
+
+//Closeness via the batched MS-BFS must match the per-source BFS exactly,
+//on one thread and on several.
+
+bool check_closeness(const SocialNetwork& network, const string& graphName) {
+    auto graph = network.snapshot();
+    unordered_map<int, double> expected = reference_closeness(*graph);
+
+    bool passed = true;
+    for (int threads : {1, 4}) {
+        unordered_map<int, double> actual = calculate_closeness_scores(*graph, threads);
+        int mismatches = actual.size() == expected.size() ? 0 : 1;
+        for (const auto& [userID, score] : expected) {
+            auto it = actual.find(userID);
+            if (it == actual.end() || it->second != score) mismatches++;
+        }
+        if (mismatches > 0) {
+            cout << "  FAIL closeness (" << graphName << ", " << threads << " thread(s)): "
+                 << mismatches << " score(s) differ from the per-source BFS" << endl;
+            passed = false;
+        }
+    }
+    if (passed) {
+        cout << "  ok   closeness (" << graphName << ", " << graph->num_users() << " users)" << endl;
+    }
+    return passed;
+}
+
+
+//Betweenness from a plain Brandes pass per source (queue BFS, predecessor
+//lists, one accumulator), in the same units as calculate_betweenness_scores.
+
+vector<double> reference_betweenness(const GraphSnapshot& graph) {
+    int N = graph.num_users();
+    vector<double> scores(N, 0.0);
+    for (int s = 0; s < N; ++s) {
+        vector<int> distance(N, -1), order;
+        vector<double> paths(N, 0.0), dependency(N, 0.0);
+        vector<vector<int>> predecessors(N);
+        distance[s] = 0;
+        paths[s] = 1.0;
+        order.push_back(s);
+        for (size_t head = 0; head < order.size(); ++head) {
+            int v = order[head];
+            for (int w : graph.neighbors_of(v)) {
+                if (distance[w] == -1) {
+                    distance[w] = distance[v] + 1;
+                    order.push_back(w);
+                }
+                if (distance[w] == distance[v] + 1) {
+                    paths[w] += paths[v];
+                    predecessors[w].push_back(v);
+                }
+            }
+        }
+        for (size_t i = order.size(); i-- > 1;) {
+            int w = order[i];
+            for (int v : predecessors[w]) dependency[v] += paths[v] / paths[w] * (1.0 + dependency[w]);
+            scores[w] += dependency[w];
+        }
+    }
+    for (double& score : scores) score /= 2.0;
+    return scores;
+}
+
+
+//Exact betweenness must match the reference Brandes up to rounding, repeat
+//bit for bit on the same thread count, and agree across thread counts.
+//(On a smaller generated graph: the reference is O(N * E).)
+
+bool check_betweenness() {
+    SocialNetwork network;
+    load_disconnected_graph(network, 1000);
+    string graphName = "disconnected graph, " + to_string(network.num_users()) + " users";
+    auto graph = network.snapshot();
+    vector<double> expected = reference_betweenness(*graph);
+    auto run = [&](int threads) {
+        unordered_map<int, double> byUser = calculate_betweenness_scores(*graph, threads);
+        vector<double> scores(graph->num_users());
+        for (int v = 0; v < graph->num_users(); ++v) scores[v] = byUser[graph->user_id(v)];
+        return scores;
+    };
+    auto close = [](const vector<double>& a, const vector<double>& b, double tolerance) {
+        for (size_t v = 0; v < a.size(); ++v) {
+            if (fabs(a[v] - b[v]) > tolerance * max(1.0, fabs(b[v]))) return false;
+        }
+        return a.size() == b.size();
+    };
+
+    vector<string> problems;
+    vector<double> single = run(1), parallel = run(4);
+    if (!close(single, expected, 1e-9)) problems.push_back("1 thread differs from the reference Brandes");
+    if (!close(parallel, single, 1e-12)) problems.push_back("1 and 4 threads differ by more than rounding");
+    if (run(4) != parallel) problems.push_back("two 4-thread runs are not bit-identical");
+
+    for (const string& problem : problems) {
+        cout << "  FAIL betweenness (" << graphName << "): " << problem << endl;
+    }
+    if (!problems.empty()) return false;
+    cout << "  ok   betweenness (" << graphName << ", against the reference Brandes, 1 and 4 threads)" << endl;
+    return true;
+}
+
+//Direction-optimizing BFS must give the same distances as a plain BFS, the
+//path lengths of bfs.cpp's get_shortest_path, and a parent tree made of
+//shortest-path edges, on one thread and on several.
+
+bool check_direction_optimizing_bfs(const SocialNetwork& network, const string& graphName) {
+    auto graph = network.snapshot();
+    int N = graph->num_users();
+
+    // Every user on small graphs; otherwise a fixed sample, including the
+    // last users (the path, the star and the isolated users when generated)
+    vector<int> sources;
+    for (int v = 0; v < N; ++v) {
+        if (N <= 64 || v % (N / 32) == 0 || v >= N - 8) sources.push_back(v);
+    }
+    mt19937 rng(2024);
+    uniform_int_distribution<int> pickTarget(0, max(0, N - 1));
+
+    int mismatches = 0;
+    for (int threads : {1, 4}) {
+        for (int source : sources) {
+            BFSResult result = direction_optimizing_bfs(*graph, source, threads);
+            vector<int> expected = reference_distances(*graph, source);
+
+            for (int v = 0; v < N; ++v) {
+                int parent = result.parent[v];
+                bool valid = result.distance[v] == expected[v];
+                if (v == source || expected[v] == -1) {
+                    valid = valid && parent == -1;
+                } else {
+                    auto friends = graph->neighbors_of(v);
+                    valid = valid && parent >= 0 && expected[parent] == expected[v] - 1 &&
+                            binary_search(friends.begin(), friends.end(), parent);
+                }
+                if (!valid) mismatches++;
+            }
+
+            // Spot-check path lengths from the menu's shortest-path search
+            for (int i = 0; i < (N <= 64 ? N : 16); ++i) {
+                int target = N <= 64 ? i : pickTarget(rng);
+                vector<int> path = get_shortest_path(network, graph->user_id(source), graph->user_id(target));
+                int hops = path.empty() ? -1 : (int)path.size() - 1;
+                if (hops != result.distance[target]) mismatches++;
+            }
+        }
+    }
+
+    if (mismatches > 0) {
+        cout << "  FAIL direction-optimizing BFS (" << graphName << "): "
+             << mismatches << " distance(s) or parent(s) differ from the plain BFS" << endl;
+        return false;
+    }
+    cout << "  ok   direction-optimizing BFS (" << graphName << ", " << sources.size()
+         << " sources, 1 and 4 threads)" << endl;
+    return true;
+}
+
+
+//A network written with GraphStore and loaded with load_binary must answer
+//every read accessor like the original, and stay editable. A truncated file,
+//a damaged header and a damaged payload must all be rejected.
+
+bool check_binary_graph(const SocialNetwork& network, const string& graphName) {
+    filesystem::path dir = filesystem::temp_directory_path();
+    string binFile = (dir / "check_graph.bin").string();
+    string badFile = (dir / "check_graph_bad.bin").string();
+    vector<string> problems;
+
+    SocialNetwork loaded;
+    if (!GraphStore::write(network, binFile) || !loaded.load_binary(binFile)) {
+        problems.push_back("round trip failed to write or load");
+    } else {
+        // --- 1. Round trip: same users, friends, tags and CSR ---
+        if (loaded.num_users() != network.num_users() || loaded.get_all_users() != network.get_all_users() ||
+            loaded.snapshot()->fingerprint() != network.snapshot()->fingerprint()) {
+            problems.push_back("users or CSR differ after the round trip");
+        }
+        int mismatches = 0;
+        for (int userID : network.get_all_users()) {
+            if (!loaded.user_exists(userID) || loaded.get_degree(userID) != network.get_degree(userID) ||
+                loaded.get_friends(userID) != network.get_friends(userID) ||
+                loaded.get_tags(userID) != network.get_tags(userID) ||
+                loaded.get_tag_ids(userID) != network.get_tag_ids(userID)) {
+                mismatches++;
+            }
+        }
+        for (int tagID = 0; tagID < network.tag_dictionary().size(); ++tagID) {
+            vector<int> expected = network.get_tag_users(tagID), actual = loaded.get_tag_users(tagID);
+            sort(expected.begin(), expected.end());
+            sort(actual.begin(), actual.end());
+            if (actual != expected || loaded.tag_dictionary().name(tagID) != network.tag_dictionary().name(tagID)) {
+                mismatches++;
+            }
+        }
+        if (mismatches > 0) problems.push_back(to_string(mismatches) + " user(s) or tag(s) differ after the round trip");
+
+        // --- 2. The first edit moves the network off the mapping ---
+        int userA = *network.get_all_users().begin(), userB = userA;
+        for (int userID : network.get_all_users()) {
+            if (userID != userA && !network.get_friends(userA).count(userID)) { userB = userID; break; }
+        }
+        ostringstream quiet; // add_friendship reports to cout
+        streambuf* console = cout.rdbuf(quiet.rdbuf());
+        loaded.add_friendship(userA, userB);
+        cout.rdbuf(console);
+        if (userB == userA || !loaded.get_friends(userA).count(userB) || !loaded.get_friends(userB).count(userA) ||
+            loaded.get_degree(userA) != network.get_degree(userA) + 1 || loaded.num_users() != network.num_users() ||
+            loaded.snapshot()->num_edges() != network.snapshot()->num_edges() + 1) {
+            problems.push_back("an edit after load_binary was not applied");
+        }
+    }
+
+    // --- 3. Damaged copies ---
+    string bytes;
+    {
+        ifstream in(binFile, ios::binary);
+        bytes.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    }
+    auto write_bad = [&](const string& content) {
+        ofstream(badFile, ios::binary | ios::trunc).write(content.data(), content.size());
+    };
+    write_bad(bytes.substr(0, bytes.size() - 8));
+    if (MappedGraph::open(badFile, nullptr, false)) problems.push_back("a truncated file was accepted");
+    write_bad(bytes.substr(0, 16));
+    if (MappedGraph::open(badFile, nullptr, false)) problems.push_back("a file shorter than its header was accepted");
+
+    string damaged = bytes;
+    damaged[16] ^= 1; // numUsers
+    write_bad(damaged);
+    if (MappedGraph::open(badFile, nullptr, false)) problems.push_back("a damaged header was accepted");
+
+    damaged = bytes;
+    damaged[damaged.size() / 2] ^= 1; // inside the neighbor array
+    write_bad(damaged);
+    auto unverified = MappedGraph::open(badFile, nullptr, false);
+    if (MappedGraph::open(badFile)) problems.push_back("a damaged payload passed verification on open");
+    if (!unverified || unverified->verify()) problems.push_back("a damaged payload was not caught by verify()");
+
+    filesystem::remove(binFile);
+    filesystem::remove(badFile);
+    for (const string& problem : problems) {
+        cout << "  FAIL binary graph (" << graphName << "): " << problem << endl;
+    }
+    if (!problems.empty()) return false;
+    cout << "  ok   binary graph (" << graphName << ", round trip, edit, truncation and corruption)" << endl;
+    return true;
+}
+
+//intersect_sorted must match std::set_intersection on random sorted arrays:
+//sizes below one 4-wide block, blocks with unequal tails, and size ratios on
+//both sides of the gallop cut-over (32), with and without an output array.
+
+bool check_intersection() {
+    mt19937 rng(99);
+    auto random_sorted = [&](size_t size, int range) {
+        vector<int> values;
+        uniform_int_distribution<int> pick(0, range - 1);
+        while (values.size() < size) {
+            values.push_back(pick(rng));
+            if (values.size() == size) {
+                sort(values.begin(), values.end());
+                values.erase(unique(values.begin(), values.end()), values.end());
+            }
+        }
+        return values;
+    };
+
+    // (small size, large size) pairs; the rest are random
+    vector<pair<size_t, size_t>> sizes = {{0, 0}, {0, 5}, {1, 1}, {3, 3}, {3, 4}, {4, 4}, {5, 3}, {4, 7},
+                                          {8, 8}, {9, 13}, {7, 223}, {7, 224}, {7, 225}, {1, 32}, {2, 64}};
+    uniform_int_distribution<size_t> pickSmall(0, 40), pickRatio(1, 48);
+    for (int trial = 0; trial < 20000; ++trial) {
+        size_t small = pickSmall(rng);
+        sizes.push_back({small, small * pickRatio(rng) + trial % 4});
+    }
+
+    int mismatches = 0;
+    vector<int> out, expected;
+    for (const auto& [smallSize, largeSize] : sizes) {
+        // Dense value ranges give many common values, sparse ones few
+        int range = static_cast<int>(largeSize * (smallSize % 2 ? 2 : 8) + 1);
+        vector<int> a = random_sorted(smallSize, range), b = random_sorted(largeSize, range);
+        expected.clear();
+        set_intersection(a.begin(), a.end(), b.begin(), b.end(), back_inserter(expected));
+
+        for (bool swapped : {false, true}) {
+            const vector<int>& x = swapped ? b : a;
+            const vector<int>& y = swapped ? a : b;
+            out.assign(min(x.size(), y.size()) + 1, -1);
+            size_t count = intersect_sorted(x.data(), x.size(), y.data(), y.size(), out.data());
+            out.resize(count);
+            if (out != expected || intersect_sorted(x.data(), x.size(), y.data(), y.size()) != expected.size()) {
+                mismatches++;
+            }
+        }
+    }
+    if (mismatches > 0) {
+        cout << "  FAIL intersection: " << mismatches << " of " << 2 * sizes.size()
+             << " intersections differ from std::set_intersection" << endl;
+        return false;
+    }
+    cout << "  ok   intersection (" << 2 * sizes.size() << " random pairs against std::set_intersection)" << endl;
+    return true;
+}
+
+
+//Triangle counts must match a brute-force count (every u < v < w with all
+//three friendships), and Adamic-Adar and common-neighbor scores must match a
+//plain std::set_intersection of the two rows, on one thread and on several.
+
+bool check_triangles(const SocialNetwork& network, const string& graphName) {
+    auto graph = network.snapshot();
+    int N = graph->num_users();
+
+    vector<long long> expected(N, 0);
+    for (int u = 0; u < N; ++u) {
+        auto rowU = graph->neighbors_of(u);
+        for (int v : rowU) {
+            if (v <= u) continue;
+            for (int w : graph->neighbors_of(v)) {
+                if (w > v && binary_search(rowU.begin(), rowU.end(), w)) {
+                    expected[u]++;
+                    expected[v]++;
+                    expected[w]++;
+                }
+            }
+        }
+    }
+
+    int mismatches = 0;
+    for (int threads : {1, 4}) {
+        if (count_triangles(*graph, threads) != expected) mismatches++;
+    }
+
+    // Every friendship plus random pairs (mostly non-friends)
+    vector<pair<int, int>> pairs;
+    for (int u = 0; u < N; ++u) {
+        for (int v : graph->neighbors_of(u)) pairs.push_back({u, v});
+    }
+    mt19937 rng(7);
+    uniform_int_distribution<int> pickUser(0, max(0, N - 1));
+    for (int i = 0; i < 2000 && N > 0; ++i) pairs.push_back({pickUser(rng), pickUser(rng)});
+
+    vector<double> expectedScores;
+    vector<int> expectedCommon;
+    for (const auto& [u, v] : pairs) {
+        auto rowU = graph->neighbors_of(u), rowV = graph->neighbors_of(v);
+        vector<int> common;
+        set_intersection(rowU.begin(), rowU.end(), rowV.begin(), rowV.end(), back_inserter(common));
+        double score = 0.0;
+        for (int w : common) {
+            if (graph->degree(w) > 1) score += 1.0 / log(graph->degree(w));
+        }
+        expectedScores.push_back(score);
+        expectedCommon.push_back(static_cast<int>(common.size()));
+    }
+    for (int threads : {1, 4}) {
+        if (adamic_adar_batch(*graph, pairs, threads) != expectedScores) mismatches++;
+        if (common_neighbors_batch(*graph, pairs, threads) != expectedCommon) mismatches++;
+    }
+
+    if (mismatches > 0) {
+        cout << "  FAIL triangles (" << graphName << "): " << mismatches
+             << " run(s) differ from the brute-force triangles or pair scores" << endl;
+        return false;
+    }
+    long long total = 0;
+    for (long long count : expected) total += count;
+    cout << "  ok   triangles (" << graphName << ", " << total / 3 << " triangles, "
+         << pairs.size() << " scored pairs, 1 and 4 threads)" << endl;
+    return true;
+}
+
+//On a path longer than the landmark rows can store (65534 hops), queries
+//must fall back to BFS (or stay within the true distance), never report a
+//clamped hop count as exact.
+
+bool check_landmark_saturation() {
+    const int length = 70000;
+    filesystem::path dir = filesystem::temp_directory_path();
+    string edgeFile = (dir / "check_path_edges.txt").string();
+    string tagFile = (dir / "check_path_tags.txt").string();
+    {
+        ofstream edges(edgeFile), tags(tagFile);
+        for (int u = 0; u + 1 < length; ++u) edges << u << " " << u + 1 << "\n";
+    }
+    SocialNetwork network;
+    network.load_data_parallel(edgeFile, tagFile);
+    filesystem::remove(edgeFile);
+    filesystem::remove(tagFile);
+
+    auto oracle = LandmarkOracle::build(network.snapshot());
+    vector<pair<int, int>> pairs = {{0, length - 1}, {1, length - 1}, {0, 100}, {0, 65534}, {0, 65535},
+                                    {200, 65800}, {length / 2, length / 2 + 3}};
+    for (int landmark : oracle->landmark_users()) pairs.push_back({landmark, length - 1});
+
+    int mismatches = 0;
+    for (const auto& [a, b] : pairs) {
+        int hops = abs(a - b); // the only path
+        HopEstimate estimate = oracle->query(a, b);
+        if (!estimate.known) continue; // BFS answers it
+        bool valid = estimate.connected && estimate.lower <= hops && hops <= estimate.upper;
+        if (!valid || (estimate.exact() && estimate.upper != hops)) mismatches++;
+    }
+    if (mismatches > 0) {
+        cout << "  FAIL landmark saturation: " << mismatches << " of " << pairs.size()
+             << " queries gave bounds that miss the true distance" << endl;
+        return false;
+    }
+    cout << "  ok   landmark saturation (" << length << "-user path, " << pairs.size() << " queries)" << endl;
+    return true;
+}
+
+//load_data_parallel() must agree with load_data() for every thread count,
+//including files whose last line has no trailing newline.
+
+bool check_parallel_load() {
+    filesystem::path dir = filesystem::temp_directory_path();
+    string edgeFile = (dir / "check_nonl_edges.txt").string();
+    string tagFile = (dir / "check_nonl_tags.txt").string();
+    {
+        ofstream edges(edgeFile), tags(tagFile);
+        for (int u = 0; u < 500; ++u) edges << u << " " << (u * 7 + 1) % 500 << "\n" << u << " " << (u * 13 + 5) % 500 << "\n";
+        edges << "3 499"; // no newline at the end
+        for (int u = 0; u < 500; u += 3) tags << u << " t" << u % 11 << " t" << u % 5 << "\n";
+        tags << "499 last";
+    }
+    SocialNetwork reference;
+    reference.load_data(edgeFile, tagFile);
+
+    int mismatches = 0;
+    for (int threads : {1, 2, 3, 8}) {
+        SocialNetwork network;
+        network.load_data_parallel(edgeFile, tagFile, threads);
+        bool same = network.get_all_users() == reference.get_all_users();
+        for (int user : reference.get_all_users()) {
+            if (!same) break;
+            same = network.get_friends(user) == reference.get_friends(user) &&
+                   network.get_tags(user) == reference.get_tags(user);
+        }
+        if (!same) mismatches++;
+    }
+    filesystem::remove(edgeFile);
+    filesystem::remove(tagFile);
+    if (mismatches > 0) {
+        cout << "  FAIL parallel load: " << mismatches << " of 4 thread counts differ from load_data()" << endl;
+        return false;
+    }
+    cout << "  ok   parallel load (" << reference.num_users() << " users, 1-8 threads, no trailing newline)" << endl;
+    return true;
+}
+
+//The three recommenders, run on the same users twice: the second
+//(steady-state) pass must not allocate at all, as their reused workspaces promise.
+
+bool check_allocations(const SocialNetwork& network, const string& graphName) {
+    // 200 users spread over the whole ID range
+    const int count = 200;
+    vector<int> users(network.get_all_users().begin(), network.get_all_users().end());
+    sort(users.begin(), users.end());
+    if (users.size() > static_cast<size_t>(count)) {
+        vector<int> sample;
+        for (int i = 0; i < count; ++i) sample.push_back(users[users.size() * i / count]);
+        users.swap(sample);
+    }
+
+    const char* names[3] = {"influence", "proximity", "hybrid"};
+    vector<int> out;
+    auto run = [&](int algorithm) {
+        for (int userID : users) {
+            if (algorithm == 0) recommend_by_influence(network, userID, 5, out);
+            else if (algorithm == 1) recommend_by_proximity(network, userID, 5, out);
+            else recommend_by_hybrid(network, userID, 5, 0.5, 0.5, out);
+        }
+    };
+
+    bool passed = true;
+    for (int algorithm = 0; algorithm < 3; ++algorithm) {
+        run(algorithm); // warm-up: PageRank, workspace and log buffers grow here
+
+        size_t before = allocationCount.load();
+        run(algorithm);
+        size_t steady = allocationCount.load() - before;
+        if (steady > 0) {
+            cout << "  FAIL allocations (" << graphName << ", " << names[algorithm] << "): " << steady
+                 << " in " << users.size() << " steady-state queries" << endl;
+            passed = false;
+        }
+    }
+    if (passed) {
+        cout << "  ok   allocations (" << graphName << ", " << users.size()
+             << " steady-state queries per recommender)" << endl;
+    }
+    return passed;
+}
+
+//A few friendships added and removed on the generated graph: the PageRank
+//cache must update with pushes (no fallback to the power iteration) and stay
+//within the incremental tolerance of a tightly converged full run.
+
+bool check_incremental_pagerank() {
+    SocialNetwork network;
+    load_disconnected_graph(network);
+    PageRankCache cache;
+    cache.get(network);
+
+    // Users 0-7999 all have friends, so no change creates or removes a sink
+    vector<pair<int, int>> added = {{3, 4051}, {17, 7999}, {2500, 6001}};
+    int failures = 0;
+    double worst = 0.0;
+    for (int step = 0; step < 6; ++step) {
+        ostringstream quiet; // add/remove_friendship report to cout
+        streambuf* console = cout.rdbuf(quiet.rdbuf());
+        if (step < 3) {
+            network.add_friendship(added[step].first, added[step].second);
+        } else {
+            // Remove an added friendship and one from the loaded data
+            int user = step == 3 ? added[0].first : 1000 + step;
+            int friendID = step == 3 ? added[0].second : *network.get_friends(user).begin();
+            network.remove_friendship(user, friendID);
+        }
+        cout.rdbuf(console);
+
+        auto result = cache.get(network);
+        vector<double> exact = pagerank_dense(*result->graph, 0.85, 300, 1e-13);
+        double error = 0.0;
+        for (size_t v = 0; v < exact.size(); ++v) error += fabs(exact[v] - result->dense[v]);
+        worst = max(worst, error);
+        if (!result->stats.incremental || result->stats.fallback || !result->stats.converged || error > 1e-4) {
+            cout << "  FAIL incremental PageRank (step " << step << "): "
+                 << (result->stats.fallback ? result->stats.fallback : "pushed")
+                 << ", L1 error " << error << endl;
+            failures++;
+        }
+    }
+    if (failures > 0) return false;
+    cout << "  ok   incremental PageRank (disconnected graph, 3 added and 3 removed friendships, L1 error <= "
+         << worst << ")" << endl;
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    string edgeFile = argc > 2 ? argv[1] : "data/synthetic_edges.txt";
+    string tagFile = argc > 2 ? argv[2] : "data/synthetic_tags.txt";
+
+    SocialNetwork bundled;
+    bundled.load_data_parallel(edgeFile, tagFile);
+    SocialNetwork disconnected;
+    load_disconnected_graph(disconnected);
+
+    int failures = 0;
+    if (!check_parallel_load()) failures++;
+    if (!check_intersection()) failures++;
+    if (!check_betweenness()) failures++;
+    if (!check_landmark_saturation()) failures++;
+    for (const auto& [network, graphName] : {make_pair(&bundled, edgeFile),
+                                             make_pair(&disconnected, string("disconnected graph"))}) {
+        if (!check_closeness(*network, graphName)) failures++;
+        if (!check_direction_optimizing_bfs(*network, graphName)) failures++;
+        if (!check_allocations(*network, graphName)) failures++;
+        if (!check_binary_graph(*network, graphName)) failures++;
+        if (!check_triangles(*network, graphName)) failures++;
+    }
+
+    if (!check_incremental_pagerank()) failures++;
+
+    if (failures > 0) {
+        cout << failures << " check(s) failed." << endl;
+        return 1;
+    }
+    cout << "All checks passed." << endl;
+    return 0;
+}
\ No newline at end of file
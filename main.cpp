@@ -6,15 +6,27 @@
 #include <map> 
 #include <utility>
 #include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <fstream>
+#include <filesystem>
 #include "SocialNetwork.h"
 #include "algorithms/influence.h"
+#include "algorithms/minhash.h"
 #include "algorithms/proximity.h"
 #include "algorithms/hybrid.h"
 #include "algorithms/bfs.h"
 #include "algorithms/communities.h" 
+#include "algorithms/louvain.h"
 #include "algorithms/closeness.h" 
 #include "algorithms/betweenness.h"
+#include "algorithms/landmarks.h"
+#include "algorithms/neighborhood.h"
+#include "algorithms/batch.h"
+#include "algorithms/recommendation_cache.h"
 #include "WebExporter.h"
+#include "GraphStore.h"
 
 using namespace std;
 
@@ -108,7 +120,7 @@ void create_new_user(SocialNetwork& network) {
     network.add_user(newUserID, newTags);
 
     cout << "\nSuccess! User " << newUserID << " has been added." << endl;
-    cout << "Total users in network: " << network.get_all_users().size() << endl;
+    cout << "Total users in network: " << network.num_users() << endl;
     
     pause_for_enter();
 }
@@ -162,19 +174,36 @@ void get_recommendations(const SocialNetwork& network) {
         vector<int> recommendations;
         cout << "\n--- Generating Recommendations ---" << endl;
 
+        // (answers are cached until a change to the network can affect them)
+        RecommendationCache& cache = RecommendationCache::shared();
         if (typeChoice == 1) {
             cout << "Running INFLUENCE algorithm for User " << userID << "..." << endl;
-            recommendations = recommend_by_influence(network, userID, k);
+            recommendations = cache.recommend(network, userID, RecommendAlgorithm::INFLUENCE, k);
         } else if (typeChoice == 2) {
             cout << "Running PROXIMITY algorithm for User " << userID << "..." << endl;
-            recommendations = recommend_by_proximity(network, userID, k);
+            recommendations = cache.recommend(network, userID, RecommendAlgorithm::PROXIMITY, k);
         } else if (typeChoice == 3) {
             cout << "Running HYBRID algorithm for User " << userID << "..." << endl;
-            recommendations = recommend_by_hybrid(network, userID, k, 0.5, 0.5);
+            recommendations = cache.recommend(network, userID, RecommendAlgorithm::HYBRID, k, 0.5, 0.5);
         }
 
         cout << "\nTop " << k << " Recommendations:" << endl;
         print_recommendations(recommendations);
+        if (!recommendations.empty()) {
+            // Mutual friends per recommendation, from one batched intersection pass
+            auto graph = network.snapshot();
+            int u = graph->index_of(userID);
+            vector<pair<int, int>> pairs;
+            for (int recID : recommendations) pairs.push_back({u, graph->index_of(recID)});
+            vector<int> mutual = common_neighbors_batch(*graph, pairs, 1);
+            cout << "  Mutual friends: ";
+            for (size_t i = 0; i < recommendations.size(); ++i) {
+                cout << recommendations[i] << " (" << mutual[i] << ")" << (i + 1 < recommendations.size() ? ", " : "\n");
+            }
+        }
+        cout << "  (cache: " << cache.hits() << " hits / " << cache.misses() << " misses, hit rate "
+             << 100.0 * cache.hit_rate() << "%; " << cache.invalidations() << " invalidated, "
+             << cache.evictions() << " evicted)" << endl;
     }
 }
 
@@ -185,25 +214,25 @@ void find_most_central_user(const SocialNetwork& network) {
     cout << "\n--- Finding Most Central User (Closeness Centrality) ---" << endl;
     cout << "Analyzing network speed..." << endl;
     
-    // 1. Run the Closeness algorithm
-    unordered_map<int, double> closeness_scores = calculate_closeness_scores(network);
+    // 1. Run the top-1 Closeness query (BFS runs that cannot win are cut short)
+    // 2. Take the user with the highest score
+    ClosenessTopKStats stats;
+    vector<pair<int, double>> top = top_k_closeness(network, 1, true, &stats);
 
-    // 2. Find the user with the highest score
     int mostCentralUser = -1;
     double maxScore = -1.0;
-
-    for (auto const& [userID, score] : closeness_scores) {
-        if (score > maxScore) {
-            maxScore = score;
-            mostCentralUser = userID;
-        }
+    if (!top.empty()) {
+        mostCentralUser = top[0].first;
+        maxScore = top[0].second;
     }
+    cout << "  Searches cut short: " << stats.sourcesPruned << " of "
+         << stats.sourcesPruned + stats.sourcesExplored << endl;
 
     // 3. Print Results
     cout << "\n--------------------------------------------------" << endl;
     if (mostCentralUser != -1) {
         // Closeness = (N - 1) / SumOfDistances. We need the inverse to show the average path length (in hops).
-        int N = network.get_all_users().size();
+        int N = network.num_users();
         double sum_of_distances = (N - 1) / maxScore;
         double avg_distance = sum_of_distances / (N - 1);
 
@@ -286,10 +315,33 @@ void find_shortest_path(const SocialNetwork& network) {
         cout << "  Error: User " << endUser << " not found. Please try again." << endl;
     }
 
-    // 3. Run BFS
+    // 3. Hop count only? The landmark index usually answers without a search.
+    cout << "1. Hop count only (distance index)" << endl;
+    cout << "2. Full path (BFS)" << endl;
+    int mode = get_int_input("Choose (1-2): ");
+    if (mode == 1) {
+        shared_ptr<const LandmarkOracle> oracle = LandmarkOracleCache::shared().get(network);
+        HopEstimate estimate = oracle->query(startUser, endUser);
+        if (estimate.exact()) {
+            if (estimate.connected) {
+                cout << "\nUser " << startUser << " and User " << endUser << " are "
+                     << estimate.upper << " hops apart (from the distance index)." << endl;
+            } else {
+                cout << "\nNo path found between User " << startUser << " and User " << endUser << "." << endl;
+            }
+            pause_for_enter();
+            return;
+        }
+        if (estimate.known) {
+            cout << "  Distance index: between " << estimate.lower << " and " << estimate.upper
+                 << " hops; searching for the exact count..." << endl;
+        }
+    }
+
+    // 4. Run BFS
     vector<int> path = get_shortest_path(network, startUser, endUser);
 
-    // 4. Print Path
+    // 5. Print Path
     if (path.empty()) {
         cout << "\nNo path found between User " << startUser << " and User " << endUser << "." << endl;
     } else {
@@ -307,18 +359,53 @@ void find_shortest_path(const SocialNetwork& network) {
  
 void analyze_communities(const SocialNetwork& network) {
     cout << "\n--- Analyzing Network Communities ---" << endl;
-    cout << "Running Label Propagation Algorithm..." << endl;
+    cout << "1. Label Propagation (fast)" << endl;
+    cout << "2. Louvain (modularity-based, reports quality)" << endl;
+    int method = get_int_input("Choose a method (1-2): ");
 
     // Clear previous log history and set algorithm info
     LogManager::clear();
-    LogManager::setAlgorithm(
-        "Community Detection",
-        "Using Label Propagation to identify clusters of densely connected users. Each node iteratively adopts the most common label among its neighbors.",
-        -1
-    );
-
-    // 1. Run the algorithm
-    unordered_map<int, int> community_map = detect_communities(network);
+    unordered_map<int, int> community_map;
+    if (method == 2) {
+        cout << "Running Louvain Algorithm..." << endl;
+        LogManager::setAlgorithm(
+            "Community Detection (Louvain)",
+            "Using the Louvain method to identify clusters of densely connected users. Users join the neighboring community that most raises modularity, then each community is collapsed into one node and the process repeats.",
+            -1
+        );
+
+        // 1. Run the algorithm
+        LouvainStats stats;
+        community_map = detect_communities_louvain(network, 0, &stats);
+        for (int level = 0; level < stats.levels; ++level) {
+            cout << "  Level " << level + 1 << ": " << stats.communities[level] << " communities, modularity "
+                 << stats.modularity[level] << " (" << stats.sweeps[level] << " sweeps)" << endl;
+        }
+    } else {
+        cout << "Running Label Propagation Algorithm..." << endl;
+        LogManager::setAlgorithm(
+            "Community Detection",
+            "Using Label Propagation to identify clusters of densely connected users. Each node iteratively adopts the most common label among its neighbors.",
+            -1
+        );
+
+        // 1. Run the algorithm (or patch the last result if only a few edits were made)
+        bool cached = false;
+        shared_ptr<const CommunityResult> result = CommunityCache::shared().get(network, &cached);
+        community_map = result->labels;
+        if (cached) {
+            cout << "  No changes since the last run; reusing its communities" << endl;
+        } else if (result->incremental) {
+            cout << "  Updated after " << result->changesApplied << " change(s): "
+                 << result->update.evaluated << " users re-checked, " << result->update.relabelled
+                 << " relabelled in " << result->update.rounds << " round(s)" << endl;
+        } else {
+            cout << "  Rounds: " << result->full.rounds << (result->full.converged ? " (converged)" : " (round limit)")
+                 << "; labels changed per round:";
+            for (int changed : result->full.changesPerRound) cout << " " << changed;
+            cout << endl;
+        }
+    }
 
     // 2. Post-process the results to print them nicely
     // We want to group users by their final community ID
@@ -348,10 +435,32 @@ void analyze_communities(const SocialNetwork& network) {
  
 void find_bridge_users(const SocialNetwork& network) {
     cout << "\n--- Finding 'Bridge' Users (Betweenness Centrality) ---" << endl;
-    cout << "Analyzing network connections..." << endl;
+    cout << "1. Exact (every user as a source; slow on large networks)" << endl;
+    cout << "2. Approximate (sample random shortest paths)" << endl;
+    int mode = get_int_input("Choose a method (1-2): ");
 
     // 1. Run the Betweenness algorithm
-    unordered_map<int, double> betweenness_scores = calculate_betweenness_scores(network);
+    unordered_map<int, double> betweenness_scores;
+    if (mode == 2) {
+        double epsilon = 0.01;
+        cout << "Enter the error bound epsilon (e.g. 0.01): ";
+        if (!(cin >> epsilon) || epsilon <= 0 || epsilon >= 1) {
+            epsilon = 0.01;
+            cin.clear();
+            cout << "  Using epsilon = " << epsilon << endl;
+        }
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+
+        cout << "Sampling shortest paths..." << endl;
+        BetweennessApproxStats stats;
+        betweenness_scores = approximate_betweenness_scores(network, epsilon, 0.1, 5, 0, &stats);
+        cout << "  Samples: " << stats.samples << " of " << stats.sampleBudget
+             << (stats.stoppedEarly ? " (stopped early: top 5 stable)" : "") << endl;
+        cout << "  Estimated error: +/- " << stats.errorBound << " (normalized), with 90% confidence" << endl;
+    } else {
+        cout << "Analyzing network connections..." << endl;
+        betweenness_scores = calculate_betweenness_scores(network);
+    }
 
     // 2. Find the top 5 users
     // We put them in a vector<pair<score, userID>> to sort them
@@ -378,18 +487,288 @@ void find_bridge_users(const SocialNetwork& network) {
     pause_for_enter();
 }
 
+
+//Counts triangles and prints the clustering summary and the most clustered users.
+ 
+void analyze_clustering(const SocialNetwork& network) {
+    cout << "\n--- Triangles & Clustering ---" << endl;
+    cout << "Counting friend triangles..." << endl;
+
+    auto graph = network.snapshot();
+    TriangleStats stats;
+    vector<long long> triangles = count_triangles(*graph, 0, &stats);
+    vector<double> clustering = local_clustering(*graph, triangles);
+
+    // Top 5 users by triangle count
+    vector<pair<long long, int>> ranked;
+    for (int v = 0; v < graph->num_users(); ++v) {
+        if (triangles[v] > 0) ranked.push_back({triangles[v], v});
+    }
+    size_t k = min(ranked.size(), size_t(5));
+    partial_sort(ranked.begin(), ranked.begin() + k, ranked.end(), greater<pair<long long, int>>());
+
+    cout << "\n--------------------------------------------------" << endl;
+    cout << "Triangles (friend trios): " << stats.triangles << endl;
+    cout << "  Transitivity (global clustering): " << stats.transitivity << endl;
+    cout << "  Average local clustering: " << stats.averageClustering << endl;
+    if (k > 0) cout << "Users in the most triangles:" << endl;
+    for (size_t i = 0; i < k; ++i) {
+        int v = ranked[i].second;
+        cout << "  " << (i + 1) << ". User " << graph->user_id(v) << " (" << ranked[i].first
+             << " triangles, clustering " << clustering[v] << ")" << endl;
+    }
+    cout << "--------------------------------------------------" << endl;
+
+    pause_for_enter();
+}
+
 // --- Main Function ---
-int main() {
+int main(int argc, char* argv[]) {
     // --- Store filenames ---
     string edgeFile = "data/synthetic_edges.txt";
     string tagFile = "data/synthetic_tags.txt";
+    string binFile = "data/synthetic_graph.bin";
+    string journalFile = "data/synthetic_changes.journal";
+    string landmarkFile = "data/synthetic_graph.landmarks";
+
+    // --- Command-line converter: ./recommender --convert <edges> <tags> <out.bin> ---
+    if (argc > 1 && string(argv[1]) == "--convert") {
+        if (argc != 5) {
+            cerr << "Usage: " << argv[0] << " --convert <edgeFile> <tagFile> <binFile>" << endl;
+            return 1;
+        }
+        if (!GraphStore::convert(argv[2], argv[3], argv[4])) return 1;
+        cout << "Wrote binary graph " << argv[4] << endl;
+        return 0;
+    }
+
+    // --- Loader benchmark: ./recommender --bench-ingest <edges> <tags> [threads] ---
+    if (argc > 1 && string(argv[1]) == "--bench-ingest") {
+        if (argc < 4) {
+            cerr << "Usage: " << argv[0] << " --bench-ingest <edgeFile> <tagFile> [threads]" << endl;
+            return 1;
+        }
+        int threads = argc > 4 ? atoi(argv[4]) : 0;
+
+        SocialNetwork baseline;
+        auto startTime = chrono::steady_clock::now();
+        baseline.load_data(argv[2], argv[3]);
+        double baselineSeconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+
+        SocialNetwork fast;
+        IngestStats stats = fast.load_data_parallel(argv[2], argv[3], threads);
+        double mb = stats.bytes / 1e6;
+
+        cout << "Input: " << mb << " MB, " << stats.edges << " edge lines, " << stats.tagLines << " tag lines" << endl;
+        cout << "  load_data:          " << baselineSeconds << " s  ("
+             << mb / baselineSeconds << " MB/s, " << stats.edges / baselineSeconds << " edges/s)" << endl;
+        cout << "  load_data_parallel: " << stats.seconds << " s  ("
+             << stats.mb_per_second() << " MB/s, " << stats.edges_per_second() << " edges/s, "
+             << stats.threads << " threads)" << endl;
+
+        // The binary path: header checks only, then with every section verified
+        // (the hash sets are not built until the first mutation either way)
+        string benchBin = (filesystem::temp_directory_path() / "bench_ingest.bin").string();
+        if (GraphStore::write(fast, benchBin)) {
+            for (bool verify : {false, true}) {
+                SocialNetwork mapped;
+                startTime = chrono::steady_clock::now();
+                bool loaded = mapped.load_binary(benchBin, verify);
+                double binarySeconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+                if (loaded) {
+                    cout << (verify ? "  load_binary+verify: " : "  load_binary:        ") << binarySeconds
+                         << " s  (" << filesystem::file_size(benchBin) / 1e6 << " MB file, "
+                         << mapped.num_users() << " users)" << endl;
+                }
+            }
+            filesystem::remove(benchBin);
+        }
+        return 0;
+    }
+
+    // --- LSH report: ./recommender --bench-lsh <edges> <tags> [bands] [rows] [queries] [top_k] ---
+    // Compares influence recommendations from the MinHash/LSH candidates with
+    // the exact path (every user sharing a tag) on random tagged users.
+    if (argc > 1 && string(argv[1]) == "--bench-lsh") {
+        int bands = argc > 4 ? atoi(argv[4]) : 16;
+        int rows = argc > 5 ? atoi(argv[5]) : 4;
+        int queries = argc > 6 ? atoi(argv[6]) : 200;
+        int top_k = argc > 7 ? atoi(argv[7]) : 5;
+        if (argc < 4 || bands < 1 || rows < 1 || queries < 1 || top_k < 1) {
+            cerr << "Usage: " << argv[0] << " --bench-lsh <edgeFile> <tagFile> [bands] [rows] [queries] [top_k]" << endl;
+            return 1;
+        }
+
+        SocialNetwork benchNetwork;
+        benchNetwork.load_data_parallel(argv[2], argv[3]);
+
+        auto startTime = chrono::steady_clock::now();
+        auto index = TagLSHIndex::build(benchNetwork, bands, rows);
+        double buildSeconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+
+        vector<int> tagged;
+        for (int userID : benchNetwork.get_all_users()) {
+            if (!benchNetwork.get_tag_ids(userID).empty()) tagged.push_back(userID);
+        }
+        if (tagged.empty()) {
+            cerr << "  Error: No user has tags." << endl;
+            return 1;
+        }
+        sort(tagged.begin(), tagged.end());
+        recommend_by_influence(benchNetwork, tagged[0], top_k); // compute PageRank outside the timings
+
+        mt19937 rng(12345);
+        uniform_int_distribution<int> pickUser(0, static_cast<int>(tagged.size()) - 1);
+        double exactSeconds = 0.0, lshSeconds = 0.0;
+        long long exactCandidates = 0, lshCandidates = 0;
+        size_t expected = 0, found = 0;
+        unordered_map<int, int> sharedTags;
+        vector<int> candidates;
+        for (int q = 0; q < queries; ++q) {
+            int userID = tagged[pickUser(rng)];
+
+            auto queryStart = chrono::steady_clock::now();
+            vector<int> exact = recommend_by_influence(benchNetwork, userID, top_k);
+            auto queryMid = chrono::steady_clock::now();
+            vector<int> approximate = recommend_by_influence_lsh(benchNetwork, userID, top_k, *index);
+            auto queryEnd = chrono::steady_clock::now();
+
+            exactSeconds += chrono::duration<double>(queryMid - queryStart).count();
+            lshSeconds += chrono::duration<double>(queryEnd - queryMid).count();
+
+            count_shared_tags(benchNetwork, userID, sharedTags);
+            index->candidates(userID, candidates);
+            exactCandidates += sharedTags.size();
+            lshCandidates += candidates.size();
+
+            expected += exact.size();
+            for (int recID : approximate) {
+                if (find(exact.begin(), exact.end(), recID) != exact.end()) found++;
+            }
+        }
+
+        cout << "Index: " << index->size() << " tagged users, " << bands << " bands x " << rows
+             << " rows (threshold Jaccard ~" << index->threshold() << "), built in " << buildSeconds << " s" << endl;
+        cout << "  exact (shared tags): " << 1000.0 * exactSeconds / queries << " ms/query, "
+             << (double)exactCandidates / queries << " candidates" << endl;
+        cout << "  MinHash/LSH:         " << 1000.0 * lshSeconds / queries << " ms/query, "
+             << (double)lshCandidates / queries << " candidates  (" << exactSeconds / lshSeconds << "x faster)" << endl;
+        cout << "  recall@" << top_k << ": " << (expected > 0 ? 100.0 * found / expected : 100.0)
+             << "% of the exact top-" << top_k << " over " << queries << " queries" << endl;
+        return 0;
+    }
+
+    // --- Path benchmark: ./recommender --bench-path [users] [friendsPerUser] [queries] ---
+    // Builds a random synthetic network and times one-sided vs bidirectional BFS
+    // on the same random user pairs.
+    if (argc > 1 && string(argv[1]) == "--bench-path") {
+        int users = argc > 2 ? atoi(argv[2]) : 200000;
+        int friendsPerUser = argc > 3 ? atoi(argv[3]) : 10;
+        int queries = argc > 4 ? atoi(argv[4]) : 200;
+        if (users < 2 || friendsPerUser < 1 || queries < 1) {
+            cerr << "Usage: " << argv[0] << " --bench-path [users] [friendsPerUser] [queries]" << endl;
+            return 1;
+        }
+
+        // Write the synthetic graph as ordinary edge/tag files and load it
+        mt19937 rng(12345);
+        uniform_int_distribution<int> pickUser(0, users - 1);
+        filesystem::path dir = filesystem::temp_directory_path();
+        string benchEdges = (dir / "bench_path_edges.txt").string();
+        string benchTags = (dir / "bench_path_tags.txt").string();
+        {
+            ofstream edges(benchEdges), tags(benchTags);
+            for (int u = 0; u < users; ++u) {
+                tags << u << " bench\n";
+                for (int f = 0; f < friendsPerUser / 2; ++f) {
+                    int v = pickUser(rng);
+                    if (v != u) edges << u << " " << v << "\n";
+                }
+            }
+        }
+        SocialNetwork benchNetwork;
+        benchNetwork.load_data_parallel(benchEdges, benchTags);
+        filesystem::remove(benchEdges);
+        filesystem::remove(benchTags);
+
+        double oneSidedSeconds = 0.0, bidirectionalSeconds = 0.0;
+        int mismatches = 0;
+        long long totalHops = 0;
+        for (int q = 0; q < queries; ++q) {
+            int a = pickUser(rng), b = pickUser(rng);
+
+            auto startTime = chrono::steady_clock::now();
+            vector<int> oneSided = get_shortest_path_unidirectional(benchNetwork, a, b);
+            auto midTime = chrono::steady_clock::now();
+            vector<int> bidirectional = get_shortest_path(benchNetwork, a, b);
+            auto endTime = chrono::steady_clock::now();
+
+            oneSidedSeconds += chrono::duration<double>(midTime - startTime).count();
+            bidirectionalSeconds += chrono::duration<double>(endTime - midTime).count();
+            if (oneSided.size() != bidirectional.size()) mismatches++;
+            if (!oneSided.empty()) totalHops += oneSided.size() - 1;
+        }
+
+        cout << "Graph: " << users << " users, ~" << friendsPerUser << " friends each; "
+             << queries << " random queries (average " << (double)totalHops / queries << " hops)" << endl;
+        cout << "  one-sided BFS:     " << 1000.0 * oneSidedSeconds / queries << " ms/query" << endl;
+        cout << "  bidirectional BFS: " << 1000.0 * bidirectionalSeconds / queries << " ms/query  ("
+             << oneSidedSeconds / bidirectionalSeconds << "x faster)" << endl;
+        if (mismatches > 0) {
+            cout << "  WARNING: " << mismatches << " queries returned different path lengths" << endl;
+            return 1;
+        }
+        return 0;
+    }
 
     // 1. Load Data
+    // Prefer the binary graph when it is newer than the text files; otherwise
+    // parse the text and refresh the binary for the next start.
+    // Unsaved edits live in the journal and are replayed on top of either source.
     SocialNetwork network;
-    network.load_data(edgeFile, tagFile);
+    network.enable_journal(journalFile);
+    if (!GraphStore::is_fresh(binFile, edgeFile, tagFile) || !network.load_binary(binFile)) {
+        network.load_data_parallel(edgeFile, tagFile);
+        GraphStore::write(network, binFile);
+    }
+    
+    LandmarkOracleCache::shared().set_file(landmarkFile);
+
+    // --- Batch job: ./recommender --batch-recommend <influence|proximity|hybrid> <out.tsv> [top_k] [threads] [usersFile] ---
+    // Computes recommendations for every user (or those listed in usersFile,
+    // one ID per line) on the loaded network and writes them as TSV.
+    if (argc > 1 && string(argv[1]) == "--batch-recommend") {
+        BatchOptions options;
+        if (argc < 4 || !parse_recommend_algorithm(argv[2], options.algorithm)) {
+            cerr << "Usage: " << argv[0]
+                 << " --batch-recommend <influence|proximity|hybrid> <out.tsv> [top_k] [threads] [usersFile]" << endl;
+            return 1;
+        }
+        if (argc > 4) options.top_k = atoi(argv[4]);
+        if (argc > 5) options.threads = atoi(argv[5]);
+
+        vector<int> users;
+        if (argc > 6) {
+            ifstream list(argv[6]);
+            int userID;
+            while (list >> userID) users.push_back(userID);
+        } else {
+            users.assign(network.get_all_users().begin(), network.get_all_users().end());
+            sort(users.begin(), users.end());
+        }
+
+        BatchStats stats;
+        vector<vector<int>> recommendations = recommend_batch(network, users, options, &stats);
+        if (!write_recommendations_tsv(argv[3], users, recommendations)) return 1;
+        cout << "Wrote top-" << options.top_k << " " << argv[2] << " recommendations for " << stats.users
+             << " users to " << argv[3] << endl;
+        cout << "  " << stats.seconds << " s, " << stats.users_per_second() << " users/s ("
+             << stats.threads << " threads)" << endl;
+        return 0;
+    }
     
     cout << "--- Friendship Recommender System Loaded ---" << endl;
-    cout << "Total users in network: " << network.get_all_users().size() << endl;
+    cout << "Total users in network: " << network.num_users() << endl;
 
 while (true) {
         cout << "\n--- Main Menu ---" << endl;
@@ -403,8 +782,9 @@ while (true) {
         cout << "8. Save Network (Manual)" << endl; 
         cout << "9. Save and Exit" << endl;
         cout << "10. Export to Web Dashboard" << endl;
+        cout << "11. Triangles & Clustering" << endl;
         
-        int choice = get_int_input("Enter your choice (1-10): ");
+        int choice = get_int_input("Enter your choice (1-11): ");
 
         if (choice == 1) {
             get_recommendations(network);
@@ -422,19 +802,22 @@ while (true) {
             find_bridge_users(network); 
         } else if (choice == 8) {
             cout << "\nSaving network data..." << endl;
-            network.save_data(edgeFile, tagFile);
+            network.commit_changes(edgeFile, tagFile);
             pause_for_enter();
         } else if (choice == 9) {
             cout << "\nSaving all changes before exiting..." << endl;
-            network.save_data(edgeFile, tagFile);
+            network.commit_changes(edgeFile, tagFile);
             break; // Exit
         }
         else if (choice == 10) {
             cout << "\nGenerating Dashboard Data..." << endl;
             WebExporter::export_graph(network);
         } 
+        else if (choice == 11) {
+            analyze_clustering(network);
+        }
         else {
-            cout << "  Error: Invalid choice. Please select 1-9." << endl;
+            cout << "  Error: Invalid choice. Please select 1-11." << endl;
             continue;
         }
     }